@@ -0,0 +1,118 @@
+# -*- Mode: Python; coding: utf-8; indent-tabs-mode: nil; tab-width: 4 -*-
+#
+# Copyright (C) 2017 Canonical Ltd.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+# Measures the frame rate each output reaches when the shell renders to several
+# outputs at once. Needs at least two connected outputs, ideally in the same
+# DisplaySyncGroup (e.g. clone mode on Android), to be meaningful.
+
+from mir_perf_framework import PerformanceTest, Server, Client
+import time
+import statistics
+import shutil
+import report_types
+
+####### TEST #######
+
+
+def perform_test():
+    shell = Server(executable=shutil.which("qtmir-demo-shell"),
+                   env={"QT_QPA_PLATFORM": "mirserver"})
+    client = Client(executable=shutil.which("qtmir-demo-client"),
+                    server=shell,
+                    env={"QT_QPA_PLATFORM": "ubuntumirclient"},
+                    options=["--", "--desktop_file_hint=/usr/share/applications/qtmir-demo-client.desktop"])
+
+    test = PerformanceTest([shell, client])
+    test.start()
+
+    results = report_types.Results()
+    processes = report_types.Processes()
+    processes.add_child(report_types.Process("Shell", shell.process.pid))
+    processes.add_child(report_types.Process("Client", client.process.pid))
+    results.add_child(processes)
+
+    time.sleep(3) # wait for settle
+    time.sleep(10) # the demo client animates continuously, just let it run
+
+    test.stop()
+
+    ####### TRACE PARSING #######
+
+    trace = test.babeltrace()
+
+    shell_pid = shell.process.pid
+    swap_timestamps = {}
+    group_posts = []
+
+    for event in trace.events:
+        if event["vpid"] != shell_pid:
+            continue
+
+        if event.name == "qtmirserver:screenSwapped":
+            output_id = event["output_id"]
+            if output_id not in swap_timestamps: swap_timestamps[output_id] = []
+            swap_timestamps[output_id].append(event.timestamp)
+
+        elif event.name == "qtmirserver:displayGroupPosted":
+            group_posts.append(event["screen_count"])
+
+    if len(swap_timestamps) < 2:
+        results.add_child(report_types.Error("Less than two outputs rendered, cannot measure multi-output frame rate"))
+
+    # FRAME RATE PER OUTPUT
+    for output_id, timestamps in sorted(swap_timestamps.items()):
+        if len(timestamps) < 3:
+            results.add_child(report_types.Error("Not enough frames rendered on output %d" % output_id))
+            continue
+
+        frame_rate = []
+        last_timestamp = -1
+        for next_timestamp in timestamps:
+            if last_timestamp != -1:
+                diff = (next_timestamp - last_timestamp) / 1000000000.0
+                if diff > 0:
+                    frame_rate.append(1.0 / diff)
+            last_timestamp = next_timestamp
+
+        frame_rate_xml = report_types.ResultsData(
+            "output_%d_frame_rate" % output_id,
+            statistics.mean(frame_rate),
+            statistics.stdev(frame_rate),
+            "Frames per second rendered on output %d" % output_id)
+        for value in frame_rate:
+            frame_rate_xml.add_data(value)
+        results.add_child(frame_rate_xml)
+        frame_rate_xml.generate_histogram("output_%d_frame_rate" % output_id)
+
+    # SCREENS POSTED TOGETHER
+    if len(group_posts) > 1:
+        group_posts_xml = report_types.ResultsData(
+            "screens_per_post",
+            statistics.mean(group_posts),
+            statistics.stdev(group_posts),
+            "Number of screens flipped by each DisplaySyncGroup post")
+        for value in group_posts:
+            group_posts_xml.add_data(value)
+        results.add_child(group_posts_xml)
+    else:
+        results.add_child(report_types.Error("No DisplaySyncGroup post data"))
+
+    return results
+
+if __name__ == "__main__":
+    results = perform_test();
+    f = open("multi_output_frame_rate.xml", "w")
+    f.write(results.to_string())
@@ -0,0 +1,119 @@
+# -*- Mode: Python; coding: utf-8; indent-tabs-mode: nil; tab-width: 4 -*-
+#
+# Copyright (C) 2017 Canonical Ltd.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+# Measures what rendering windows stacked under others costs, with and without
+# occlusion culling. Starts 20 continuously animating clients on top of each
+# other, then compares CPU time used by the shell and the clients, and the number
+# of client frames the shell got notified of.
+
+from mir_perf_framework import PerformanceTest, Server, Client
+import os
+import time
+import shutil
+import report_types
+
+WINDOW_COUNT = 20
+RUN_SECONDS = 10
+
+####### HELPERS #######
+
+
+def cpu_seconds(pid):
+    with open("/proc/%d/stat" % pid) as stat:
+        # utime and stime, fields 14 and 15, counted after the parenthesised command name
+        fields = stat.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+
+
+def run(occlusion_culling):
+    shell = Server(executable=shutil.which("qtmir-demo-shell"),
+                   env={"QT_QPA_PLATFORM": "mirserver",
+                        "QTMIR_OCCLUSION_CULLING": "1" if occlusion_culling else "0"})
+    clients = [Client(executable=shutil.which("qtmir-demo-client"),
+                      server=shell,
+                      env={"QT_QPA_PLATFORM": "ubuntumirclient"},
+                      options=["--", "--desktop_file_hint=/usr/share/applications/qtmir-demo-client.desktop"])
+               for i in range(WINDOW_COUNT)]
+
+    test = PerformanceTest([shell] + clients)
+    test.start()
+
+    time.sleep(3) # wait for settle
+
+    shell_start = cpu_seconds(shell.process.pid)
+    clients_start = sum(cpu_seconds(client.process.pid) for client in clients)
+    time.sleep(RUN_SECONDS)
+    shell_cpu = cpu_seconds(shell.process.pid) - shell_start
+    clients_cpu = sum(cpu_seconds(client.process.pid) for client in clients) - clients_start
+
+    test.stop()
+
+    ####### TRACE PARSING #######
+
+    trace = test.babeltrace()
+
+    frame_notifications = 0
+    occluded_count = 0
+    for event in trace.events:
+        if event["vpid"] != shell.process.pid:
+            continue
+
+        if event.name == "qtmir:framesPostedNotified":
+            frame_notifications += 1
+        elif event.name == "qtmir:occlusionUpdated":
+            occluded_count = event["occluded_count"]
+
+    return {
+        "shell_cpu": 100.0 * shell_cpu / RUN_SECONDS,
+        "clients_cpu": 100.0 * clients_cpu / RUN_SECONDS,
+        "frame_notifications": frame_notifications / RUN_SECONDS,
+        "occluded_windows": occluded_count,
+    }
+
+####### TEST #######
+
+
+def perform_test():
+    results = report_types.Results()
+
+    runs = {"unculled": run(occlusion_culling=False), "culled": run(occlusion_culling=True)}
+
+    descriptions = {
+        "shell_cpu": "CPU usage of the shell, in percent of one core",
+        "clients_cpu": "CPU usage of all clients together, in percent of one core",
+        "frame_notifications": "Client frame notifications handled by the shell per second",
+        "occluded_windows": "Windows found occluded by the last occlusion pass",
+    }
+
+    for name, values in sorted(runs.items()):
+        for key, description in sorted(descriptions.items()):
+            result = report_types.ResultsData(
+                "%s_%s" % (name, key),
+                values[key],
+                0,
+                "%s, %s occlusion culling" % (description, "with" if name == "culled" else "without"))
+            result.add_data(values[key])
+            results.add_child(result)
+
+    if runs["culled"]["occluded_windows"] == 0:
+        results.add_child(report_types.Error("No window got occluded, the clients may not be stacked on top of each other"))
+
+    return results
+
+if __name__ == "__main__":
+    results = perform_test();
+    f = open("occluded_windows.xml", "w")
+    f.write(results.to_string())
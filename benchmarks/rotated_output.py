@@ -0,0 +1,127 @@
+# -*- Mode: Python; coding: utf-8; indent-tabs-mode: nil; tab-width: 4 -*-
+#
+# Copyright (C) 2017 Canonical Ltd.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+# Measures what showing the shell upside down costs, when the shell rotates its whole
+# QML scene, and when the output gets rotated through the display configuration
+# instead, which leaves a single rotated pass at swap time. Starts a few
+# continuously animating clients, then compares the render and swap times of the
+# shell's frames, the vsyncs it missed and the CPU time it used.
+
+from mir_perf_framework import PerformanceTest, Server, Client
+import os
+import time
+import shutil
+import statistics
+import report_types
+
+WINDOW_COUNT = 5
+RUN_SECONDS = 10
+
+####### HELPERS #######
+
+
+def cpu_seconds(pid):
+    with open("/proc/%d/stat" % pid) as stat:
+        # utime and stime, fields 14 and 15, counted after the parenthesised command name
+        fields = stat.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+
+
+def run(shell_env):
+    env = {"QT_QPA_PLATFORM": "mirserver"}
+    env.update(shell_env)
+    shell = Server(executable=shutil.which("qtmir-demo-shell"), env=env)
+    clients = [Client(executable=shutil.which("qtmir-demo-client"),
+                      server=shell,
+                      env={"QT_QPA_PLATFORM": "ubuntumirclient"},
+                      options=["--", "--desktop_file_hint=/usr/share/applications/qtmir-demo-client.desktop"])
+               for i in range(WINDOW_COUNT)]
+
+    test = PerformanceTest([shell] + clients)
+    test.start()
+
+    time.sleep(3) # wait for settle
+
+    shell_start = cpu_seconds(shell.process.pid)
+    time.sleep(RUN_SECONDS)
+    shell_cpu = cpu_seconds(shell.process.pid) - shell_start
+
+    test.stop()
+
+    ####### TRACE PARSING #######
+
+    trace = test.babeltrace()
+
+    render_ns = []
+    swap_ns = []
+    missed_vsyncs = 0
+    for event in trace.events:
+        if event["vpid"] != shell.process.pid:
+            continue
+
+        if event.name == "qtmirserver:screenFrameTiming":
+            render_ns.append(event["render_ns"])
+            swap_ns.append(event["swap_ns"])
+            missed_vsyncs += event["missed_vsyncs"]
+
+    return {
+        "render_us": statistics.mean(render_ns) / 1000 if render_ns else 0,
+        "swap_us": statistics.mean(swap_ns) / 1000 if swap_ns else 0,
+        "missed_vsyncs": missed_vsyncs,
+        "frames": len(render_ns),
+        "shell_cpu": 100.0 * shell_cpu / RUN_SECONDS,
+    }
+
+####### TEST #######
+
+
+def perform_test():
+    results = report_types.Results()
+
+    runs = {
+        "scene_rotated": run({"QTMIR_DEMO_SHELL_ROTATION": "180"}),
+        "output_rotated": run({"QTMIR_OUTPUT_ORIENTATION": "180"}),
+    }
+
+    descriptions = {
+        "render_us": "Mean time the shell took to render a frame, in microseconds",
+        "swap_us": "Mean time the shell took to swap a frame, in microseconds",
+        "missed_vsyncs": "Vsyncs missed by the shell",
+        "frames": "Frames posted by the shell",
+        "shell_cpu": "CPU usage of the shell, in percent of one core",
+    }
+
+    for name, values in sorted(runs.items()):
+        for key, description in sorted(descriptions.items()):
+            result = report_types.ResultsData(
+                "%s_%s" % (name, key),
+                values[key],
+                0,
+                "%s, %s" % (description, "rotating the QML scene" if name == "scene_rotated" else "rotating the output"))
+            result.add_data(values[key])
+            results.add_child(result)
+
+    for name, values in sorted(runs.items()):
+        if values["frames"] == 0:
+            results.add_child(report_types.Error("No frame timing got traced for %s, is lttng enabled?" % name))
+
+    return results
+
+if __name__ == "__main__":
+    results = perform_test();
+    f = open("rotated_output.xml", "w")
+    f.write(results.to_string())
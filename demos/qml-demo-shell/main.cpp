@@ -46,6 +46,10 @@ int main(int argc, const char *argv[])
     qmlRegisterSingletonType<PointerPosition>("Mir.Pointer", 0, 1, "PointerPosition",
         [](QQmlEngine*, QJSEngine*) -> QObject* { return PointerPosition::instance(); });
 
+    // The old way of showing the shell on a rotated output, kept for comparing with rotating the
+    // output itself (QTMIR_OUTPUT_ORIENTATION). See benchmarks/rotated_output.py
+    view->rootContext()->setContextProperty("shellRotation", qgetenv("QTMIR_DEMO_SHELL_ROTATION").toInt());
+
     QUrl source(::qmlDirectory() + "qml-demo-shell/windowModel.qml");
 
     view->setSource(source);
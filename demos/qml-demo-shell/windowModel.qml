@@ -5,6 +5,7 @@ import Mir.Pointer 0.1
 FocusScope {
     id: root
     focus: true
+    rotation: shellRotation // in degrees, meant to be 0 or 180
 
     WindowModel {
         id: windowModel;
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTSCANOUTINTERFACE_H
+#define DIRECTSCANOUTINTERFACE_H
+
+#include <memory>
+
+namespace mir { namespace graphics { class Buffer; }}
+
+namespace qtmir {
+
+// Lets the scene graph hand a client buffer straight to the display of a Screen, skipping
+// composition. Obtained per QWindow from the platform native interface, resource "DirectScanout".
+//
+// Must be called from the render thread of the window, once it synchronized and before it renders.
+class DirectScanoutInterface {
+public:
+    DirectScanoutInterface() = default;
+    virtual ~DirectScanoutInterface() = default;
+
+    // Offers a buffer covering the whole screen, opaque and not covered by anything else, to be
+    // scanned out in place of the frame about to be rendered. Must be offered again for every frame.
+    //
+    // Returns whether the display commits to scanning it out, in which case the scene graph leaves
+    // it out of the frame. That only happens once the display scanned out previousBuffer, what the
+    // same item offered for the previous frame. Should the display fail to keep its commitment, it
+    // drops the frame and gets the scene rendered again, with nothing left out.
+    virtual bool offerScanoutBuffer(const std::shared_ptr<mir::graphics::Buffer> &buffer,
+                                    const std::shared_ptr<mir::graphics::Buffer> &previousBuffer) = 0;
+};
+
+} // namespace qtmir
+
+#endif // DIRECTSCANOUTINTERFACE_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECAPTUREINTERFACE_H
+#define FRAMECAPTUREINTERFACE_H
+
+#include <QImage>
+#include <QSize>
+
+#include <functional>
+#include <memory>
+
+namespace qtmir {
+
+// A frame read back from the GPU. Its pixels live in a slot of a shared memory ring, which gets
+// reused once the last reference to the frame is dropped.
+struct CapturedFrame
+{
+    int fd{-1};                    // the shared memory, for handing the frame over to another process
+    const uchar *pixels{nullptr};  // the same memory, mapped in this process
+    QSize size;
+    int bytesPerLine{0};
+    QImage::Format format{QImage::Format_RGBA8888}; // rows go from top to bottom
+    quint64 sequence{0};           // counts the frames read back from the same source
+    qint64 timestamp{0};           // when the frame got rendered, in ns of the monotonic clock
+};
+
+// The pixels of the frame as an image, without copying them. Must not outlive the frame.
+inline QImage frameImage(const CapturedFrame &frame)
+{
+    return QImage(frame.pixels, frame.size.width(), frame.size.height(), frame.bytesPerLine, frame.format);
+}
+
+// Called with a null frame when one was due but couldn't be captured
+using FrameHandler = std::function<void(const std::shared_ptr<const CapturedFrame> &frame)>;
+
+// Lets the shell capture what a Screen shows without stalling its render thread. Obtained per
+// QWindow from the platform native interface, resource "FrameCapture".
+//
+// Frames are read back asynchronously and handed over a frame or two after being rendered.
+// Handlers are called from the render thread of the window, so must return quickly. Holding on
+// to the frame is what keeps its pixels around. A handler may still get a frame that was being
+// handed over while stopCapturing() was called.
+//
+// All methods can be called from any thread.
+class FrameCaptureInterface {
+public:
+    FrameCaptureInterface() = default;
+    virtual ~FrameCaptureInterface() = default;
+
+    // Hands the next frame shown on the screen to the handler, once
+    virtual void captureNextFrame(const FrameHandler &handler) = 0;
+
+    // Hands every frame shown on the screen to the handler, until stopCapturing() is called with
+    // the id returned. Frames are skipped while handlers still hold on to all the ring slots.
+    // A non-zero maxFramesPerSecond leaves out frames coming sooner than that rate allows, before
+    // they get read back.
+    virtual int startCapturing(const FrameHandler &handler, int maxFramesPerSecond = 0) = 0;
+    virtual void stopCapturing(int id) = 0;
+};
+
+} // namespace qtmir
+
+#endif // FRAMECAPTUREINTERFACE_H
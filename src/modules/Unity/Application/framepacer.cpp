@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "framepacer.h"
+#include "timer.h"
+
+// Qt
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtMath>
+
+// std
+#include <limits>
+
+using namespace qtmir;
+
+namespace {
+
+// Rationale behind the drop interval of exposed surfaces:
+// We want it to be big enough not to interfere with a regular rendering cycle
+// ie, we should give the compositor plenty of time to consume the surface frame
+// before we drop it. Only screens refreshing below 20Hz get more than the fixed
+// interval, so that they still have a few refresh periods to do so.
+const int minimumExposedSurfaceDropInterval = 200; // in milliseconds
+const int exposedSurfaceRefreshPeriods = 4;
+
+const qreal defaultHiddenSurfaceMinimumFps = 5;
+const qreal defaultRefreshRate = 60;
+
+qreal hiddenSurfaceMinimumFpsFromEnvironment()
+{
+    bool ok;
+    const qreal fps = qgetenv("QTMIR_HIDDEN_SURFACE_MIN_FPS").toDouble(&ok);
+    return ok && fps > 0 ? fps : defaultHiddenSurfaceMinimumFps;
+}
+
+} // namespace {
+
+FramePacer::FramePacer(AbstractTimer *timer, const SharedTimeSource &timeSource, QObject *parent)
+    : QObject(parent)
+    , m_timer(timer)
+    , m_timeSource(timeSource)
+    , m_hiddenSurfaceMinimumFps(hiddenSurfaceMinimumFpsFromEnvironment())
+{
+    m_timer->setParent(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &AbstractTimer::timeout, this, &FramePacer::dropDueFrames);
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+FramePacer *FramePacer::instance()
+{
+    static FramePacer *instance;
+    if (!instance) {
+        instance = new FramePacer(new Timer, SharedTimeSource(new RealTimeSource));
+    }
+    return instance;
+}
+
+void FramePacer::schedule(Surface *surface)
+{
+    m_deadlines[surface] = m_timeSource->msecsSinceReference() + dropInterval(surface->isExposed());
+    updateTimer();
+}
+
+void FramePacer::unschedule(Surface *surface)
+{
+    if (m_deadlines.remove(surface) > 0) {
+        updateTimer();
+    }
+}
+
+bool FramePacer::isScheduled(Surface *surface) const
+{
+    return m_deadlines.contains(surface);
+}
+
+int FramePacer::dropInterval(bool exposed) const
+{
+    if (exposed) {
+        return qMax(minimumExposedSurfaceDropInterval, qCeil(exposedSurfaceRefreshPeriods * 1000 / refreshRate()));
+    } else {
+        return qCeil(1000 / m_hiddenSurfaceMinimumFps);
+    }
+}
+
+void FramePacer::setRefreshRate(qreal refreshRate)
+{
+    m_refreshRate = refreshRate;
+}
+
+qreal FramePacer::refreshRate() const
+{
+    if (m_refreshRate > 0) {
+        return m_refreshRate;
+    }
+
+    // A surface may be shown on any screen, so pace after the slowest one
+    qreal refreshRate = 0;
+    if (qGuiApp) {
+        Q_FOREACH (QScreen *screen, qGuiApp->screens()) {
+            if (screen->refreshRate() > 0 && (refreshRate == 0 || screen->refreshRate() < refreshRate)) {
+                refreshRate = screen->refreshRate();
+            }
+        }
+    }
+    return refreshRate > 0 ? refreshRate : defaultRefreshRate;
+}
+
+void FramePacer::setHiddenSurfaceMinimumFps(qreal fps)
+{
+    if (fps > 0) {
+        m_hiddenSurfaceMinimumFps = fps;
+    }
+}
+
+void FramePacer::dropDueFrames()
+{
+    const qint64 now = m_timeSource->msecsSinceReference();
+
+    QList<Surface*> dueSurfaces;
+    for (auto it = m_deadlines.constBegin(); it != m_deadlines.constEnd(); ++it) {
+        if (it.value() <= now) {
+            dueSurfaces.append(it.key());
+        }
+    }
+
+    Q_FOREACH (Surface *surface, dueSurfaces) {
+        // May have been unscheduled by the surfaces dropped before it
+        if (m_deadlines.remove(surface) == 0) {
+            continue;
+        }
+        if (surface->dropPendingFrames()) {
+            m_deadlines[surface] = now + dropInterval(surface->isExposed());
+        }
+    }
+
+    updateTimer();
+}
+
+void FramePacer::updateTimer()
+{
+    if (m_deadlines.isEmpty()) {
+        m_timer->stop();
+        return;
+    }
+
+    qint64 nextDeadline = std::numeric_limits<qint64>::max();
+    Q_FOREACH (qint64 deadline, m_deadlines) {
+        nextDeadline = qMin(nextDeadline, deadline);
+    }
+
+    m_timer->setInterval(qMax<qint64>(0, nextDeadline - m_timeSource->msecsSinceReference()));
+    m_timer->start();
+}
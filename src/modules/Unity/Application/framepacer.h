@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QTMIR_FRAMEPACER_H
+#define QTMIR_FRAMEPACER_H
+
+#include "timesource.h"
+
+#include <QHash>
+#include <QObject>
+
+namespace qtmir {
+
+class AbstractTimer;
+
+/*
+    Drops the client frames that surfaces leave pending for the compositor, so that clients don't
+    get stuck waiting for a free buffer when nobody consumes theirs.
+
+    Frames of exposed surfaces are given at least 200ms to get composited, more only if the
+    slowest screen refreshes so slowly that it needs a few periods for it. Hidden
+    surfaces are only kept running at a minimum frame rate, which defaults to 5fps and can be
+    changed with the QTMIR_HIDDEN_SURFACE_MIN_FPS environment variable.
+
+    All surfaces are served by a single timer. Lives in the GUI thread.
+ */
+class FramePacer : public QObject
+{
+    Q_OBJECT
+public:
+    class Surface {
+    public:
+        virtual ~Surface() = default;
+
+        // Whether the surface is exposed in any of its views
+        virtual bool isExposed() const = 0;
+
+        // Drops the frames pending for the compositor. Returns whether frames are still pending.
+        virtual bool dropPendingFrames() = 0;
+    };
+
+    // Takes ownership of the timer
+    FramePacer(AbstractTimer *timer, const SharedTimeSource &timeSource, QObject *parent = nullptr);
+    virtual ~FramePacer();
+
+    static FramePacer *instance();
+
+    // (Re)starts the countdown after which the pending frames of the surface get dropped
+    void schedule(Surface *surface);
+    void unschedule(Surface *surface);
+    bool isScheduled(Surface *surface) const;
+
+    // In milliseconds. Screens slower than 20Hz lengthen the interval of exposed surfaces.
+    int dropInterval(bool exposed) const;
+
+    // Overrides the refresh rate of the screens, or resets it if <= 0
+    void setRefreshRate(qreal refreshRate);
+    qreal refreshRate() const;
+
+    qreal hiddenSurfaceMinimumFps() const { return m_hiddenSurfaceMinimumFps; }
+    void setHiddenSurfaceMinimumFps(qreal fps);
+
+private Q_SLOTS:
+    void dropDueFrames();
+
+private:
+    void updateTimer();
+
+    AbstractTimer *m_timer;
+    SharedTimeSource m_timeSource;
+    QHash<Surface*, qint64> m_deadlines;
+    qreal m_refreshRate{0};
+    qreal m_hiddenSurfaceMinimumFps;
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_FRAMEPACER_H
@@ -18,13 +18,31 @@
 
 // Mir
 #include <mir/geometry/size.h>
+#include <mir/graphics/buffer.h>
+
+// Qt
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QtGui/private/qopenglcontext_p.h>
 
 namespace mg = mir::geometry;
 
+namespace {
+
+void freeTexture(QOpenGLFunctions *functions, GLuint textureId)
+{
+    functions->glDeleteTextures(1, &textureId);
+}
+
+} // namespace {
+
 MirBufferSGTexture::MirBufferSGTexture()
     : QSGTexture()
     , m_width(0)
     , m_height(0)
+    , m_boundTextureId(0)
+    , m_bufferBound(false)
+    , m_context(QOpenGLContext::currentContext())
     , m_textureId(0)
 {
     glGenTextures(1, &m_textureId);
@@ -36,24 +54,58 @@ MirBufferSGTexture::MirBufferSGTexture()
 
 MirBufferSGTexture::~MirBufferSGTexture()
 {
-    if (m_textureId) {
-        glDeleteTextures(1, &m_textureId);
+    // Whichever thread lets go of the texture last
+    deleteTexture(m_textureId);
+    Q_FOREACH (const ImportedTexture &importedTexture, m_importedTextures) {
+        deleteTexture(importedTexture.textureId);
     }
 }
 
 void MirBufferSGTexture::freeBuffer()
 {
+    // The GPU may still be sampling the buffer for the frames drawn so far. Rather than the client
+    // finding out the hard way, or the render thread waiting for the GPU, the client gets a fence
+    // to wait on. Only the rendering thread, with its GL context current, has commands to fence.
+    if (m_bufferBound && !m_mirBuffer.can_read_pixels() && QOpenGLContext::currentContext()) {
+        m_mirBuffer.secure_for_render();
+    }
+
     m_mirBuffer.reset();
     m_width = 0;
     m_height = 0;
+    m_bufferBound = false;
+}
+
+quint64 MirBufferSGTexture::releaseBuffers()
+{
+    quint64 bytes = 0;
+    if (hasBuffer()) {
+        const auto buffer = m_mirBuffer.buffer();
+        bytes = (quint64)m_width * m_height * MIR_BYTES_PER_PIXEL(buffer->pixel_format());
+        freeBuffer();
+    }
+    m_pixelBufferUploader.discardPrepared();
+
+    Q_FOREACH (const ImportedTexture &importedTexture, m_importedTextures) {
+        deleteTexture(importedTexture.textureId);
+    }
+    m_importedTextures.clear();
+
+    return bytes;
 }
 
 void MirBufferSGTexture::setBuffer(const std::shared_ptr<mir::graphics::Buffer>& buffer)
 {
     m_mirBuffer.reset(buffer);
+    m_bufferBound = false;
     mg::Size size = m_mirBuffer.size();
     m_height = size.height.as_int();
     m_width = size.width.as_int();
+
+    // On the rendering thread, have the pixels of software buffers copied while the scene graph syncs
+    if (QOpenGLContext::currentContext() && m_mirBuffer && m_mirBuffer.can_read_pixels()) {
+        m_pixelBufferUploader.prepare(m_mirBuffer);
+    }
 }
 
 bool MirBufferSGTexture::hasBuffer() const
@@ -61,9 +113,14 @@ bool MirBufferSGTexture::hasBuffer() const
     return m_mirBuffer;
 }
 
+std::shared_ptr<mir::graphics::Buffer> MirBufferSGTexture::buffer() const
+{
+    return m_mirBuffer.buffer();
+}
+
 int MirBufferSGTexture::textureId() const
 {
-    return m_textureId;
+    return m_bufferBound ? m_boundTextureId : m_textureId;
 }
 
 QSize MirBufferSGTexture::textureSize() const
@@ -79,12 +136,78 @@ bool MirBufferSGTexture::hasAlphaChannel() const
 void MirBufferSGTexture::bind()
 {
     Q_ASSERT(hasBuffer());
-    glBindTexture(GL_TEXTURE_2D, m_textureId);
-    updateBindOptions(true/* force */);
 
-    m_mirBuffer.bind_to_texture();
+    if (m_bufferBound) {
+        glBindTexture(GL_TEXTURE_2D, m_boundTextureId);
+        updateBindOptions(true/* force */);
+        return;
+    }
+
+    releaseTexturesOfDestroyedBuffers();
+
+    if (m_mirBuffer.can_read_pixels()) {
+        // Pixels of non-GL clients change in place, so each new frame has to be uploaded again
+        m_boundTextureId = m_textureId;
+        glBindTexture(GL_TEXTURE_2D, m_boundTextureId);
+        updateBindOptions(true/* force */);
+
+        // Streams the pixels through pixel buffer objects, leaving GL state as Qt expects it
+        if (!m_pixelBufferUploader.upload(m_mirBuffer)) {
+            m_mirBuffer.bind_to_texture();
+            m_pixelBufferUploader.textureReplaced();
+
+            // Fix for lp:1583088 - For non-GL clients, Mir uploads the client pixel buffer to a GL texture.
+            // But as it does so, it changes some GL state and neglects to restore it, which breaks Qt's rendering.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // 4 is the default which Qt uses
+        }
+    } else {
+        const auto buffer = m_mirBuffer.buffer();
+        ImportedTexture &importedTexture = m_importedTextures[buffer.get()];
+        if (!importedTexture.textureId) {
+            glGenTextures(1, &importedTexture.textureId);
+        }
+
+        m_boundTextureId = importedTexture.textureId;
+        glBindTexture(GL_TEXTURE_2D, m_boundTextureId);
+        updateBindOptions(true/* force */);
+
+        // The client renders into the buffer directly, so once imported the texture shows whatever
+        // frame it holds. Coming back to the buffer with a new frame only takes syncing with the
+        // rendering of the client, which Mir does while binding it again.
+        if (importedTexture.buffer.lock() != buffer) {
+            m_mirBuffer.bind_to_texture();
+            importedTexture.buffer = buffer;
+        } else {
+            m_mirBuffer.bind();
+        }
+    }
+
+    m_bufferBound = true;
+}
+
+// Deletes the texture right away if a GL context sharing with the one it was created in is current,
+// or else the next time one gets made current
+void MirBufferSGTexture::deleteTexture(GLuint textureId) const
+{
+    // The context took its textures along when it went
+    if (!textureId || !m_context) {
+        return;
+    }
 
-    // Fix for lp:1583088 - For non-GL clients, Mir uploads the client pixel buffer to a GL texture.
-    // But as it does so, it changes some GL state and neglects to restore it, which breaks Qt's rendering.
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // 4 is the default which Qt uses
+    auto guard = new QOpenGLSharedResourceGuard(m_context, textureId, freeTexture);
+    guard->free(); // deletes the guard as well, once done
+}
+
+// Called from the rendering thread, with the GL context current
+void MirBufferSGTexture::releaseTexturesOfDestroyedBuffers()
+{
+    auto it = m_importedTextures.begin();
+    while (it != m_importedTextures.end()) {
+        if (it->buffer.expired()) {
+            glDeleteTextures(1, &it->textureId);
+            it = m_importedTextures.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
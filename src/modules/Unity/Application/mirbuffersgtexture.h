@@ -18,11 +18,16 @@
 #define MIRBUFFERSGTEXTURE_H
 
 #include "miral/mirbuffer.h"
+#include "pixelbufferuploader.h"
 
+#include <QHash>
+#include <QPointer>
 #include <QSGTexture>
 
 #include <QtGui/qopengl.h>
 
+class QOpenGLContext;
+
 class MirBufferSGTexture : public QSGTexture
 {
     Q_OBJECT
@@ -34,6 +39,14 @@ public:
     void freeBuffer();
     bool hasBuffer() const;
 
+    // Gives back the client buffers the texture holds on to, the current one and any being uploaded,
+    // and gets rid of the textures imported from client buffers, which keep the memory of those in use
+    // for as long as they exist. Returns the bytes of the current buffer. Takes no GL, so can be called
+    // from any thread while the texture is not being drawn; the GL names go once the GL context the
+    // texture was used in is current again.
+    quint64 releaseBuffers();
+    std::shared_ptr<mir::graphics::Buffer> buffer() const;
+
     int textureId() const override;
     QSize textureSize() const override;
     bool hasAlphaChannel() const override;
@@ -42,10 +55,31 @@ public:
     void bind() override;
 
 private:
+    void deleteTexture(GLuint textureId) const;
+    void releaseTexturesOfDestroyedBuffers();
+
     miral::GLBuffer m_mirBuffer;
     int m_width;
     int m_height;
+
+    // The texture the current buffer is bound to, once it is
+    GLuint m_boundTextureId;
+    bool m_bufferBound;
+
+    // The context the textures are created in, in the rendering thread
+    const QPointer<QOpenGLContext> m_context;
+
+    // Texture the pixels of software rendered buffers get uploaded to
     GLuint m_textureId;
+    PixelBufferUploader m_pixelBufferUploader;
+
+    // GL clients cycle through a small set of buffers. Each gets imported into a texture of its own
+    // just once, until the buffer is destroyed.
+    struct ImportedTexture {
+        std::weak_ptr<mir::graphics::Buffer> buffer;
+        GLuint textureId{0};
+    };
+    QHash<const mir::graphics::Buffer*, ImportedTexture> m_importedTextures;
 };
 
 #endif // MIRBUFFERSGTEXTURE_H
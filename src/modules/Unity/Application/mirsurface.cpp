@@ -18,23 +18,28 @@
 #include "mirsurfacelistmodel.h"
 #include "namedcursor.h"
 #include "session_interface.h"
+#include "surfacethumbnail.h"
 #include "timer.h"
 #include "timestamp.h"
+#include "tracepoints.h" // generated from tracepoints.tp
 
 // from common dir
 #include <debughelpers.h>
 #include "mirqtconversion.h"
 
 // mirserver
+#include <cursorcache.h>
 #include <eventbuilder.h>
 #include <surfaceobserver.h>
 #include "screen.h"
 
 // Mir
 #include <mir/geometry/rectangle.h>
+#include <mir/graphics/buffer.h>
 #include <mir/scene/surface.h>
 #include <mir/scene/surface_observer.h>
 #include <mir/version.h>
+#include <mir_toolkit/common.h>
 #include <mir_toolkit/cursors.h>
 
 // mirserver
@@ -46,6 +51,7 @@
 #include <QScreen>
 
 // std
+#include <atomic>
 #include <limits>
 
 using namespace qtmir;
@@ -76,6 +82,15 @@ qint64 msecsSinceReference()
     return elapsedTimer.msecsSinceReference();
 }
 
+const int defaultUnviewedBufferReleaseMsecs = 2000;
+
+int unviewedBufferReleaseMsecsFromEnvironment()
+{
+    bool ok;
+    const int msecs = qgetenv("QTMIR_UNVIEWED_BUFFER_RELEASE_MS").toInt(&ok);
+    return ok ? msecs : defaultUnviewedBufferReleaseMsecs;
+}
+
 } // namespace {
 
 
@@ -87,6 +102,12 @@ public:
 
     void setListener(QObject *listener);
 
+    // Lets the next posted frame notify the listener again. Called from the GUI thread.
+    void frameNotificationConsumed();
+
+    quint64 framesPostedCount() const { return m_framesPostedCount; }
+    quint64 collapsedNotificationCount() const { return m_collapsedNotificationCount; }
+
     void attrib_changed(MirWindowAttrib, int) override;
     void resized_to(mir::geometry::Size const&) override;
     void moved_to(mir::geometry::Point const&) override {}
@@ -118,7 +139,12 @@ public:
 private:
     QCursor createQCursorFromMirCursorImage(const mir::graphics::CursorImage &cursorImage);
     QObject *m_listener;
-    bool m_framesPosted;
+
+    // Set by the first frame posted after the listener consumed the previous notification, so that
+    // only one notification at a time is queued for the GUI thread however fast the client draws
+    std::atomic<bool> m_frameNotificationPending;
+    std::atomic<quint64> m_framesPostedCount;
+    std::atomic<quint64> m_collapsedNotificationCount;
     QMap<QByteArray, Qt::CursorShape> m_cursorNameToShape;
 };
 
@@ -142,14 +168,13 @@ MirSurface::MirSurface(NewWindow newWindowInfo,
     , m_session(session)
     , m_controller(controller)
     , m_orientationAngle(Mir::Angle0)
-    , m_textureUpdated(false)
-    , m_currentFrameNumber(0)
     , m_visible(newWindowInfo.windowInfo.is_visible())
     , m_live(true)
     , m_surfaceObserver(std::make_shared<SurfaceObserverImpl>())
     , m_size(toQSize(m_window.size()))
     , m_state(toQtState(newWindowInfo.windowInfo.state()))
     , m_shellChrome(toQtShellChrome(newWindowInfo.windowInfo.shell_chrome()))
+    , m_bufferReleaseInterval(unviewedBufferReleaseMsecsFromEnvironment())
     , m_parentSurface(parentSurface)
     , m_childSurfaceList(new MirSurfaceListModel(this))
 {
@@ -187,28 +212,13 @@ MirSurface::MirSurface(NewWindow newWindowInfo,
             resize(m_pendingResize.width(), m_pendingResize.height());
             m_pendingResize = QSize(-1, -1);
         }
+        updateSnapshot();
     });
 
-    connect(&m_frameDropperTimer, &QTimer::timeout,
-            this, &MirSurface::dropPendingBuffer);
-    // Rationale behind the frame dropper and its interval value:
-    //
-    // We want to give ample room for Qt scene graph to have a chance to fetch and render
-    // the next pending buffer before we take the drastic action of dropping it (so don't set
-    // it anywhere close to our target render interval).
-    //
-    // We also want to guarantee a minimal frames-per-second (fps) frequency for client applications
-    // as they get stuck on swap_buffers() if there's no free buffer to swap to yet (ie, they
-    // are all pending consumption by the compositor, us). But on the other hand, we don't want
-    // that minimal fps to be too high as that would mean this timer would be triggered way too often
-    // for nothing causing unnecessary overhead as actually dropping frames from an app should
-    // in practice rarely happen.
-    m_frameDropperTimer.setInterval(200);
-    m_frameDropperTimer.setSingleShot(false);
-
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 
     setCloseTimer(new Timer);
+    setBufferReleaseTimer(new Timer);
 
     m_requestedPosition.rx() = std::numeric_limits<int>::min();
     m_requestedPosition.ry() = std::numeric_limits<int>::min();
@@ -220,18 +230,29 @@ MirSurface::~MirSurface()
 
     Q_ASSERT(m_views.isEmpty());
 
+    FramePacer::instance()->unschedule(this);
+
     QMutexLocker locker(&m_mutex);
     m_surface->remove_observer(m_surfaceObserver);
 
     delete m_closeTimer;
+    delete m_bufferReleaseTimer;
 
     Q_EMIT destroyed(this); // Early warning, while MirSurface methods can still be accessed.
 }
 
 void MirSurface::onFramesPostedObserved()
 {
+    // Frames posted from now on need a new notification
+    m_surfaceObserver->frameNotificationConsumed();
+    tracepoint(qtmir, framesPostedNotified, m_surfaceObserver->framesPostedCount(),
+               m_surfaceObserver->collapsedNotificationCount());
+
     // restart the frame dropper so that items have enough time to render the next frame.
-    m_frameDropperTimer.start();
+    FramePacer::instance()->schedule(this);
+
+    // The client is back, its frames can take over from the snapshot
+    updateSnapshot(true /* framePosted */);
 
     Q_EMIT framesPosted();
 }
@@ -283,135 +304,327 @@ Mir::Type MirSurface::type() const
     }
 }
 
-void MirSurface::dropPendingBuffer()
+bool MirSurface::dropPendingFrames()
 {
     QMutexLocker locker(&m_mutex);
 
-    const void* const userId = (void*)123;  // TODO: Multimonitor support
+    // Forget about compositors which are no longer drawing this surface
+    auto textureIt = m_textures.begin();
+    while (textureIt != m_textures.end()) {
+        if (!textureIt->texture) {
+            textureIt = m_textures.erase(textureIt);
+        } else {
+            ++textureIt;
+        }
+    }
 
-    int framesPending = m_surface->buffers_ready_for_compositor(userId);
-    if (framesPending == 0) {
-        // The client can't possibly be blocked in swap buffers if the
-        // queue is empty. So we can safely enter deep sleep now. If the
-        // client provides any new frames, the timer will get restarted
-        // via scheduleTextureUpdate()...
-        m_frameDropperTimer.stop();
-        return;
+    // Drop on behalf of every compositor consuming this surface, otherwise the ones
+    // left behind would still hold the client back. With none left, keep consuming under
+    // the id of the last one: any other id would be one more consumer for Mir to track
+    // for as long as the surface lives.
+    QList<qintptr> userIds = m_textures.keys();
+    if (userIds.isEmpty()) {
+        if (!m_lastCompositorId) {
+            // Nothing consumes this surface yet, the first compositor to do so reschedules us
+            return false;
+        }
+        userIds.append(m_lastCompositorId);
     }
 
-    m_textureUpdated = false;
-    auto texture = static_cast<MirBufferSGTexture*>(m_texture.data());
+    bool framesWerePending = false;
+    bool droppedFrame = false;
+    bool stillPending = false;
+
+    Q_FOREACH (const qintptr userId, userIds) {
+        const void* const mirUserId = (void*)userId;
+
+        int framesPending = m_surface->buffers_ready_for_compositor(mirUserId);
+        if (framesPending == 0) {
+            continue;
+        }
+        framesWerePending = true;
+
+        auto it = m_textures.find(userId);
+        MirBufferSGTexture *texture = nullptr;
+        if (it != m_textures.end()) {
+            it->textureUpdated = false;
+            texture = static_cast<MirBufferSGTexture*>(it->texture.data());
+        }
+
+        auto renderables = m_surface->generate_renderables(mirUserId);
+        if (renderables.size() == 0) {
+            continue;
+        }
 
-    auto renderables = m_surface->generate_renderables(userId);
-    if (renderables.size() > 0) {
-        ++m_currentFrameNumber;
         if (texture) {
             texture->freeBuffer();
             texture->setBuffer(renderables[0]->buffer());
+            ++it->currentFrameNumber;
             if (texture->textureSize() != size()) {
                 m_size = texture->textureSize();
                 QMetaObject::invokeMethod(this, "emitSizeChanged", Qt::QueuedConnection);
             }
-            m_textureUpdated = true;
-
-            framesPending = m_surface->buffers_ready_for_compositor(userId);
-            if (framesPending > 0) {
-                // restart the frame dropper to give MirSurfaceItems enough time to render the next frame.
-                // queued since the timer lives in a different thread
-                DEBUG_MSG << "() - there are still buffers ready for compositor. starting frame dropper";
-                QMetaObject::invokeMethod(&m_frameDropperTimer, "start", Qt::QueuedConnection);
-            }
+            it->textureUpdated = true;
         } else {
             // Just get a pointer to the buffer. This tells mir we consumed it.
             renderables[0]->buffer();
         }
+        droppedFrame = true;
 
-        Q_EMIT frameDropped();
+        if (m_surface->buffers_ready_for_compositor(mirUserId) > 0) {
+            stillPending = true;
+        }
+    }
 
-    } else {
+    if (!framesWerePending) {
+        // The client can't possibly be blocked in swap buffers if the
+        // queue is empty. So we can safely enter deep sleep now. If the
+        // client provides any new frames, the frame dropper will get
+        // rescheduled via onFramesPostedObserved()...
+        return false;
+    }
+
+    if (!droppedFrame) {
         WARNING_MSG << "() - failed. Giving up.";
-        m_frameDropperTimer.stop();
+        return false;
+    }
+
+    if (stillPending) {
+        DEBUG_MSG << "() - there are still buffers ready for compositor. keeping frame dropper scheduled";
     }
+
+    Q_EMIT frameDropped();
+
+    return stillPending;
+}
+
+void MirSurface::scheduleFrameDrop()
+{
+    FramePacer::instance()->schedule(this);
 }
 
 void MirSurface::stopFrameDropper()
 {
     DEBUG_MSG << "()";
-    m_frameDropperTimer.stop();
+    FramePacer::instance()->unschedule(this);
 }
 
 void MirSurface::startFrameDropper()
 {
     DEBUG_MSG << "()";
-    if (!m_frameDropperTimer.isActive()) {
-        m_frameDropperTimer.start();
+    if (!FramePacer::instance()->isScheduled(this)) {
+        FramePacer::instance()->schedule(this);
     }
 }
 
-QSharedPointer<QSGTexture> MirSurface::texture()
+QSharedPointer<QSGTexture> MirSurface::texture(qintptr userId)
 {
     QMutexLocker locker(&m_mutex);
 
-    if (!m_texture) {
+    CompositorTexture &compositorTexture = m_textures[userId];
+    if (!compositorTexture.texture) {
         QSharedPointer<QSGTexture> texture(new MirBufferSGTexture);
-        m_texture = texture.toWeakRef();
+        compositorTexture.texture = texture.toWeakRef();
+        compositorTexture.textureUpdated = false;
         return texture;
     } else {
-        return m_texture.toStrongRef();
+        return compositorTexture.texture.toStrongRef();
     }
 }
 
-bool MirSurface::updateTexture()
+QSGTexture *MirSurface::weakTexture(qintptr userId) const
 {
     QMutexLocker locker(&m_mutex);
+    return m_textures.value(userId).texture.data();
+}
+
+bool MirSurface::updateTexture(qintptr userId)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_textures.find(userId);
+    if (it == m_textures.end()) return false;
 
-    MirBufferSGTexture *texture = static_cast<MirBufferSGTexture*>(m_texture.data());
+    CompositorTexture &compositorTexture = it.value();
+    MirBufferSGTexture *texture = static_cast<MirBufferSGTexture*>(compositorTexture.texture.data());
     if (!texture) return false;
 
-    if (m_textureUpdated) {
+    if (compositorTexture.textureUpdated) {
         return texture->hasBuffer();
     }
 
-    const void* const userId = (void*)123;
-    auto renderables = m_surface->generate_renderables(userId);
+    const void* const mirUserId = (void*)userId;
+    auto renderables = m_surface->generate_renderables(mirUserId);
+    m_lastCompositorId = userId;
 
     if (renderables.size() > 0 &&
-            (m_surface->buffers_ready_for_compositor(userId) > 0 || !texture->hasBuffer())
+            (m_surface->buffers_ready_for_compositor(mirUserId) > 0 || !texture->hasBuffer())
         ) {
         // Avoid holding two buffers for the compositor at the same time. Thus free the current
         // before acquiring the next
         texture->freeBuffer();
         texture->setBuffer(renderables[0]->buffer());
-        ++m_currentFrameNumber;
+        ++compositorTexture.currentFrameNumber;
 
         if (texture->textureSize() != size()) {
             m_size = texture->textureSize();
             QMetaObject::invokeMethod(this, "emitSizeChanged", Qt::QueuedConnection);
         }
 
-        m_textureUpdated = true;
+        compositorTexture.textureUpdated = true;
     }
 
-    if (m_surface->buffers_ready_for_compositor(userId) > 0) {
+    if (m_surface->buffers_ready_for_compositor(mirUserId) > 0) {
         // restart the frame dropper to give MirSurfaceItems enough time to render the next frame.
-        // queued since the timer lives in a different thread
-        QMetaObject::invokeMethod(&m_frameDropperTimer, "start", Qt::QueuedConnection);
+        // queued since the frame pacer lives in a different thread
+        QMetaObject::invokeMethod(this, "scheduleFrameDrop", Qt::QueuedConnection);
     }
 
     return texture->hasBuffer();
 }
 
-void MirSurface::onCompositorSwappedBuffers()
+void MirSurface::onCompositorSwappedBuffers(qintptr userId)
 {
     QMutexLocker locker(&m_mutex);
-    m_textureUpdated = false;
+    auto it = m_textures.find(userId);
+    if (it != m_textures.end()) {
+        it->textureUpdated = false;
+    }
+}
+
+bool MirSurface::numBuffersReadyForCompositor(qintptr userId)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_surface->buffers_ready_for_compositor((void*)userId);
+}
+
+bool MirSurface::wantsSnapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshotState == SnapshotWanted;
+}
+
+void MirSurface::setSnapshot(const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_snapshotState != SnapshotWanted || image.isNull()) {
+        return;
+    }
+
+    m_snapshot.store(image, persistentId());
+    m_snapshotState = ShowingSnapshot;
+
+    // Views on other screens have to switch as well
+    QMetaObject::invokeMethod(this, "snapshotChanged", Qt::QueuedConnection);
+}
+
+bool MirSurface::showsSnapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshotState == ShowingSnapshot;
+}
+
+QImage MirSurface::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_snapshotState != ShowingSnapshot) {
+        return QImage();
+    }
+
+    const QImage image = m_snapshot.load();
+    if (image.isNull()) {
+        decodeSnapshot();
+    }
+    return image;
+}
+
+// Called with m_mutex locked. Views get the snapshot once it's decoded, rather than the render
+// thread waiting on it.
+void MirSurface::decodeSnapshot() const
+{
+    // Not called anymore once m_snapshot is gone, which it goes before the QObject does
+    MirSurface *surface = const_cast<MirSurface*>(this);
+    m_snapshot.decode([surface]() {
+        QMetaObject::invokeMethod(surface, "snapshotChanged", Qt::QueuedConnection);
+    });
+}
+
+QList<FrameHandler> MirSurface::takeFrameCaptures()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<FrameHandler> frameCaptures;
+    frameCaptures.swap(m_frameCaptures);
+    return frameCaptures;
+}
+
+QSharedPointer<SurfaceThumbnail> MirSurface::thumbnail(qintptr userId, const QSize &size, bool mipmap)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QSharedPointer<SurfaceThumbnail> thumbnail;
+    for (int i = m_thumbnails.count() - 1; i >= 0; i--) {
+        const CompositorThumbnail &entry = m_thumbnails.at(i);
+        if (!entry.thumbnail) {
+            m_thumbnails.removeAt(i);
+        } else if (entry.userId == userId && entry.size == size && entry.mipmap == mipmap) {
+            thumbnail = entry.thumbnail.toStrongRef();
+        }
+    }
+
+    if (!thumbnail) {
+        thumbnail.reset(new SurfaceThumbnail(size, mipmap));
+        m_thumbnails.append(CompositorThumbnail{userId, size, mipmap, thumbnail.toWeakRef()});
+    }
+    return thumbnail;
 }
 
-bool MirSurface::numBuffersReadyForCompositor()
+void MirSurface::captureNextFrame(const FrameHandler &handler)
 {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_frameCaptures.append(handler);
+    }
+    // queued as it may come from any thread
+    QMetaObject::invokeMethod(this, "frameCaptureRequested", Qt::QueuedConnection);
+}
+
+// Once the client is suspended, its views release the surface buffers and show a snapshot of the
+// last frame instead. The snapshot stays up after resuming, until the client posts a new frame.
+void MirSurface::updateSnapshot(bool framePosted)
+{
+    const SessionInterface::State sessionState = m_session ? m_session->state() : SessionInterface::State::Running;
+
     QMutexLocker locker(&m_mutex);
-    const void* const userId = (void*)123;
-    return m_surface->buffers_ready_for_compositor(userId);
+    const SnapshotState oldState = m_snapshotState;
+
+    switch (m_snapshotState) {
+    case NoSnapshot:
+        if (sessionState == SessionInterface::State::Suspended) {
+            m_snapshotState = SnapshotWanted;
+        }
+        break;
+    case SnapshotWanted:
+        // resumed before any view got to take it
+        if (sessionState != SessionInterface::State::Suspended) {
+            m_snapshotState = NoSnapshot;
+        }
+        break;
+    case ShowingSnapshot:
+        if (framePosted && sessionState == SessionInterface::State::Running) {
+            m_snapshotState = NoSnapshot;
+            m_snapshot.clear();
+        } else if (sessionState != SessionInterface::State::Suspended) {
+            // Resuming. Views may need it until the client posts a frame, so have it ready.
+            decodeSnapshot();
+        }
+        break;
+    }
+
+    if (m_snapshotState != oldState) {
+        INFO_MSG << "() snapshotState=" << m_snapshotState;
+        locker.unlock();
+        Q_EMIT snapshotChanged();
+    }
 }
 
 void MirSurface::setFocused(bool value)
@@ -753,6 +966,7 @@ void MirSurface::registerView(qintptr viewId)
     m_views.insert(viewId, MirSurface::View{false});
     INFO_MSG << "(" << viewId << ")" << " after=" << m_views.count();
     if (m_views.count() == 1) {
+        m_bufferReleaseTimer->stop();
         Q_EMIT isBeingDisplayedChanged();
     }
 }
@@ -762,6 +976,9 @@ void MirSurface::unregisterView(qintptr viewId)
     m_views.remove(viewId);
     INFO_MSG << "(" << viewId << ")" << " after=" << m_views.count() << " live=" << m_live;
     if (m_views.count() == 0) {
+        if (m_bufferReleaseInterval >= 0) {
+            m_bufferReleaseTimer->start();
+        }
         Q_EMIT isBeingDisplayedChanged();
     }
     updateExposure();
@@ -776,6 +993,51 @@ void MirSurface::setViewExposure(qintptr viewId, bool exposed)
     updateExposure();
 }
 
+void MirSurface::setOccluded(bool occluded)
+{
+    if (m_occluded == occluded) {
+        return;
+    }
+
+    INFO_MSG << "(" << occluded << ")";
+    m_occluded = occluded;
+    updateExposure();
+}
+
+bool MirSurface::isOpaque() const
+{
+    if (m_surface->alpha() < 1.0f) {
+        return false;
+    }
+
+    switch (m_surface->pixel_format()) {
+    case mir_pixel_format_xbgr_8888:
+    case mir_pixel_format_xrgb_8888:
+    case mir_pixel_format_rgb_888:
+    case mir_pixel_format_bgr_888:
+    case mir_pixel_format_rgb_565:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MirSurface::isExposed() const
+{
+    if (m_occluded) {
+        return false;
+    }
+
+    QHashIterator<qintptr, View> i(m_views);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value().exposed) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void MirSurface::updateExposure()
 {
     // Only update exposure after client has swapped a frame (aka surface is "ready"). MirAL only considers
@@ -784,11 +1046,12 @@ void MirSurface::updateExposure()
         return;
     }
 
-    bool newExposed = false;
-    QHashIterator<qintptr, View> i(m_views);
-    while (i.hasNext()) {
-        i.next();
-        newExposed |= i.value().exposed;
+    const bool newExposed = isExposed();
+
+    // Frames of hidden surfaces get dropped at a slower pace than those of exposed ones
+    FramePacer *framePacer = FramePacer::instance();
+    if (framePacer->isScheduled(this)) {
+        framePacer->schedule(this);
     }
 
     const bool oldExposed = (m_surface->query(mir_window_attrib_visibility) == mir_window_visibility_exposed);
@@ -801,10 +1064,10 @@ void MirSurface::updateExposure()
     }
 }
 
-unsigned int MirSurface::currentFrameNumber() const
+unsigned int MirSurface::currentFrameNumber(qintptr userId) const
 {
     QMutexLocker locker(&m_mutex);
-    return m_currentFrameNumber;
+    return m_textures.value(userId).currentFrameNumber;
 }
 
 void MirSurface::emitSizeChanged()
@@ -1041,6 +1304,75 @@ void MirSurface::setCloseTimer(AbstractTimer *timer)
     }
 }
 
+void MirSurface::setBufferReleaseTimer(AbstractTimer *timer)
+{
+    bool timerWasRunning = false;
+
+    if (m_bufferReleaseTimer) {
+        timerWasRunning = m_bufferReleaseTimer->isRunning();
+        delete m_bufferReleaseTimer;
+    }
+
+    m_bufferReleaseTimer = timer;
+    m_bufferReleaseTimer->setInterval(qMax(m_bufferReleaseInterval, 0));
+    m_bufferReleaseTimer->setSingleShot(true);
+    connect(m_bufferReleaseTimer, &AbstractTimer::timeout, this, &MirSurface::releaseUnviewedBuffers);
+
+    if (timerWasRunning) {
+        m_bufferReleaseTimer->start();
+    }
+}
+
+void MirSurface::releaseUnviewedBuffers()
+{
+    if (!m_views.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // Items that stopped showing the surface may still hold its texture, and with it the last
+    // client buffer they drew, plus the textures imported from the others. Give the buffers back
+    // and forget the textures. That takes no GL: the GL names get deleted by the rendering thread
+    // of the compositor, once its context is current again. Should a view come back, it gets a new
+    // texture and updateTexture() acquires the client buffer again.
+    quint64 bytes = 0;
+    auto textureIt = m_textures.begin();
+    while (textureIt != m_textures.end()) {
+        const QSharedPointer<QSGTexture> texture = textureIt->texture.toStrongRef();
+        if (texture) {
+            bytes += static_cast<MirBufferSGTexture*>(texture.data())->releaseBuffers();
+        }
+        textureIt->texture.clear();
+        textureIt->textureUpdated = false;
+        ++textureIt;
+    }
+
+    if (bytes == 0) {
+        return;
+    }
+
+    m_reclaimedBufferBytes += bytes;
+    INFO_MSG << "() bytes=" << bytes << " total=" << m_reclaimedBufferBytes;
+    tracepoint(qtmir, unviewedBuffersReleased, bytes, m_reclaimedBufferBytes);
+}
+
+quint64 MirSurface::reclaimedBufferBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_reclaimedBufferBytes;
+}
+
+quint64 MirSurface::framesPostedCount() const
+{
+    return m_surfaceObserver->framesPostedCount();
+}
+
+quint64 MirSurface::collapsedFrameNotificationCount() const
+{
+    return m_surfaceObserver->collapsedNotificationCount();
+}
+
 std::shared_ptr<SurfaceObserver> MirSurface::surfaceObserver() const
 {
     return m_surfaceObserver;
@@ -1138,7 +1470,9 @@ void MirSurface::onNameChanged(const QString &name)
 
 MirSurface::SurfaceObserverImpl::SurfaceObserverImpl()
     : m_listener(nullptr)
-    , m_framesPosted(false)
+    , m_frameNotificationPending(false)
+    , m_framesPostedCount(0)
+    , m_collapsedNotificationCount(0)
 {
     // mir cursor names, used by the mir protocol
 
@@ -1194,14 +1528,26 @@ MirSurface::SurfaceObserverImpl::~SurfaceObserverImpl()
 void MirSurface::SurfaceObserverImpl::setListener(QObject *listener)
 {
     m_listener = listener;
-    if (m_framesPosted) {
+    if (m_frameNotificationPending) {
         Q_EMIT framesPosted();
     }
 }
 
+void MirSurface::SurfaceObserverImpl::frameNotificationConsumed()
+{
+    m_frameNotificationPending = false;
+}
+
 void MirSurface::SurfaceObserverImpl::frame_posted(int /*frames_available*/, mir::geometry::Size const& /*size*/)
 {
-    m_framesPosted = true;
+    ++m_framesPostedCount;
+
+    // The listener will pick up this frame along with the ones it's already been notified about
+    if (m_frameNotificationPending.exchange(true)) {
+        ++m_collapsedNotificationCount;
+        return;
+    }
+
     if (m_listener) {
         Q_EMIT framesPosted();
     }
@@ -1266,10 +1612,10 @@ QCursor MirSurface::SurfaceObserverImpl::createQCursorFromMirCursorImage(const m
             return QCursor();
         }
     } else {
-        QImage image((const uchar*)cursorImage.as_argb_8888(),
-                     cursorImage.size().width.as_int(), cursorImage.size().height.as_int(), QImage::Format_ARGB32);
-
-        return QCursor(QPixmap::fromImage(image), cursorImage.hotspot().dx.as_int(), cursorImage.hotspot().dy.as_int());
+        // Apps switch back and forth between a few cursors, so most are already converted
+        return CursorCache::instance()->cursor(cursorImage.as_argb_8888(),
+                QSize(cursorImage.size().width.as_int(), cursorImage.size().height.as_int()),
+                QPoint(cursorImage.hotspot().dx.as_int(), cursorImage.hotspot().dy.as_int()));
     }
 }
 
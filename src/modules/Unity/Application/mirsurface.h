@@ -17,8 +17,10 @@
 #ifndef QTMIR_MIRSURFACE_H
 #define QTMIR_MIRSURFACE_H
 
+#include "framepacer.h"
 #include "mirsurfaceinterface.h"
 #include "mirsurfacelistmodel.h"
+#include "surfacesnapshot.h"
 
 // Qt
 #include <QCursor>
@@ -48,7 +50,7 @@ class AbstractTimer;
 class MirSurfaceListModel;
 class SessionInterface;
 
-class MirSurface : public MirSurfaceInterface
+class MirSurface : public MirSurfaceInterface, public FramePacer::Surface
 {
     Q_OBJECT
 
@@ -125,13 +127,21 @@ public:
     void setViewExposure(qintptr viewId, bool exposed) override;
 
     // methods called from the rendering (scene graph) thread:
-    QSharedPointer<QSGTexture> texture() override;
-    QSGTexture *weakTexture() const override { return m_texture.data(); }
-    bool updateTexture() override;
-    unsigned int currentFrameNumber() const override;
-    bool numBuffersReadyForCompositor() override;
+    QSharedPointer<QSGTexture> texture(qintptr userId) override;
+    QSGTexture *weakTexture(qintptr userId) const override;
+    bool updateTexture(qintptr userId) override;
+    unsigned int currentFrameNumber(qintptr userId) const override;
+    bool numBuffersReadyForCompositor(qintptr userId) override;
+    bool wantsSnapshot() const override;
+    void setSnapshot(const QImage &image) override;
+    bool showsSnapshot() const override;
+    QImage snapshot() const override;
+    QList<FrameHandler> takeFrameCaptures() override;
+    QSharedPointer<SurfaceThumbnail> thumbnail(qintptr userId, const QSize &size, bool mipmap) override;
     // end of methods called from the rendering (scene graph) thread
 
+    void captureNextFrame(const FrameHandler &handler) override;
+
     void setFocused(bool focus) override;
 
     void setViewActiveFocus(qintptr viewId, bool value) override;
@@ -177,8 +187,29 @@ public:
 
     // useful for tests
     void setCloseTimer(AbstractTimer *timer);
+    void setBufferReleaseTimer(AbstractTimer *timer);
     std::shared_ptr<SurfaceObserver> surfaceObserver() const;
 
+    // Frames posted by the client, and how many of them were picked up along with an earlier one
+    // rather than by a notification of their own
+    quint64 framesPostedCount() const;
+    quint64 collapsedFrameNotificationCount() const;
+
+    // Bytes of client buffers given back after the surface went without views for a while
+    quint64 reclaimedBufferBytes() const;
+
+    // Whether the client draws every pixel of the surface, fully opaque
+    bool isOpaque() const;
+
+    // Fully covered by opaque windows stacked on top. Occluded surfaces are never exposed.
+    void setOccluded(bool occluded);
+    bool isOccluded() const { return m_occluded; }
+
+    ////
+    // FramePacer::Surface
+    bool isExposed() const override;
+    bool dropPendingFrames() override;
+
 public Q_SLOTS:
     ////
     // unity::shell::application::MirSurfaceInterface
@@ -186,22 +217,25 @@ public Q_SLOTS:
 
     ////
     // qtmir::MirSurfaceInterface
-    void onCompositorSwappedBuffers() override;
+    void onCompositorSwappedBuffers(qintptr userId) override;
     void setShellChrome(Mir::ShellChrome shellChrome) override;
 
 private Q_SLOTS:
-    void dropPendingBuffer();
+    void scheduleFrameDrop();
     void onAttributeChanged(const MirWindowAttrib, const int);
     void onFramesPostedObserved();
     void emitSizeChanged();
     void setCursor(const QCursor &cursor);
     void onCloseTimedOut();
+    void releaseUnviewedBuffers();
     void setInputBounds(const QRect &rect);
 
 private:
     void syncSurfaceSizeWithItemSize();
     bool clientIsRunning() const;
     void updateExposure();
+    void updateSnapshot(bool framePosted = false);
+    void decodeSnapshot() const;
     void applyKeymap();
     void updateActiveFocus();
     void updateVisible();
@@ -239,14 +273,25 @@ private:
     //FIXME -  have to save the state as Mir has no getter for it (bug:1357429)
     Mir::OrientationAngle m_orientationAngle;
 
-    QTimer m_frameDropperTimer;
-
     mutable QMutex m_mutex;
 
-    // Lives in the rendering (scene graph) thread
-    QWeakPointer<QSGTexture> m_texture;
-    bool m_textureUpdated;
-    unsigned int m_currentFrameNumber;
+    // Lives in the rendering (scene graph) threads, one entry per compositor (userId)
+    struct CompositorTexture {
+        QWeakPointer<QSGTexture> texture;
+        bool textureUpdated{false};
+        unsigned int currentFrameNumber{0};
+    };
+    QHash<qintptr, CompositorTexture> m_textures;
+
+    // Also in the rendering threads, alive for as long as views show them
+    struct CompositorThumbnail {
+        qintptr userId;
+        QSize size;
+        bool mipmap;
+        QWeakPointer<SurfaceThumbnail> thumbnail;
+    };
+    QList<CompositorThumbnail> m_thumbnails;
+    qintptr m_lastCompositorId{0}; // already known to the buffer queue of the Mir surface
 
     bool m_ready{false};
     bool m_visible;
@@ -255,6 +300,17 @@ private:
         bool exposed;
     };
     QHash<qintptr, View> m_views;
+    bool m_occluded{false};
+
+    enum SnapshotState {
+        NoSnapshot,
+        SnapshotWanted,
+        ShowingSnapshot
+    };
+    SnapshotState m_snapshotState{NoSnapshot}; // guarded by m_mutex
+    SurfaceSnapshot m_snapshot;
+
+    QList<FrameHandler> m_frameCaptures; // guarded by m_mutex
 
     QSet<qintptr> m_activelyFocusedViews;
     bool m_neverSetSurfaceFocus{true};
@@ -284,6 +340,12 @@ private:
     ClosingState m_closingState{NotClosing};
     AbstractTimer *m_closeTimer{nullptr};
 
+    // Fires once the surface has had no views for QTMIR_UNVIEWED_BUFFER_RELEASE_MS (2000 by default).
+    // A negative interval keeps the buffers for good.
+    AbstractTimer *m_bufferReleaseTimer{nullptr};
+    const int m_bufferReleaseInterval;
+    quint64 m_reclaimedBufferBytes{0}; // guarded by m_mutex
+
     // assumes parent won't be destroyed before its children
     MirSurface *m_parentSurface;
 
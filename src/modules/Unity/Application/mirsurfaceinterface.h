@@ -22,8 +22,12 @@
 
 #include "session_interface.h"
 
+// mirserver
+#include "framecaptureinterface.h"
+
 // Qt
 #include <QCursor>
+#include <QImage>
 #include <QPoint>
 #include <QSharedPointer>
 #include <QTouchEvent>
@@ -32,6 +36,7 @@ class QHoverEvent;
 class QMouseEvent;
 class QKeyEvent;
 class QSGTexture;
+class SurfaceThumbnail;
 
 namespace qtmir {
 
@@ -56,14 +61,48 @@ public:
     virtual void unregisterView(qintptr viewId) = 0;
     virtual void setViewExposure(qintptr viewId, bool exposed) = 0;
 
-    // methods called from the rendering (scene graph) thread:
-    virtual QSharedPointer<QSGTexture> texture() = 0;
-    virtual QSGTexture *weakTexture() const = 0;
-    virtual bool updateTexture() = 0;
-    virtual unsigned int currentFrameNumber() const = 0;
-    virtual bool numBuffersReadyForCompositor() = 0;
+    /*
+        Methods called from the rendering (scene graph) thread.
+
+        userId identifies the compositor consuming the surface buffers, one per QQuickWindow
+        (and thus per Screen and render thread). Each compositor gets its own texture and
+        consumes the client buffer queue independently from the others.
+     */
+    virtual QSharedPointer<QSGTexture> texture(qintptr userId) = 0;
+    virtual QSGTexture *weakTexture(qintptr userId) const = 0;
+    virtual bool updateTexture(qintptr userId) = 0;
+    virtual unsigned int currentFrameNumber(qintptr userId) const = 0;
+    virtual bool numBuffersReadyForCompositor(qintptr userId) = 0;
+
+    /*
+        Snapshot of the last frame, which views show instead of the surface buffers while the
+        client is suspended, and until it posts a new frame after resuming.
+        The first view to render once the snapshot is wanted provides it.
+     */
+    virtual bool wantsSnapshot() const = 0;
+    virtual void setSnapshot(const QImage &image) = 0;
+    virtual bool showsSnapshot() const = 0;
+    virtual QImage snapshot() const = 0;
+
+    /*
+        Frame captures asked for through captureNextFrame(). The first view to render the surface
+        then reads its texture back.
+     */
+    virtual QList<FrameHandler> takeFrameCaptures() = 0;
+
+    /*
+        Downscaled copy of the texture of the given compositor, shared by all of its views showing
+        the surface at that size, so that it gets drawn once per frame no matter how many there are.
+     */
+    virtual QSharedPointer<SurfaceThumbnail> thumbnail(qintptr userId, const QSize &size, bool mipmap) = 0;
     // end of methods called from the rendering (scene graph) thread
 
+    /*
+        Hands the next frame of the surface, as rendered by any of its views, to the handler.
+        Can be called from any thread, and the handler gets called from a rendering thread.
+     */
+    virtual void captureNextFrame(const FrameHandler &handler) = 0;
+
     /*
         Defines the unityapi::MirSurfaceInterface::focused() value, which is what shell sees.
         Set centrally by MirFocusController and used for window-management purposes by shell.
@@ -110,7 +149,7 @@ public:
     virtual void requestFocus() = 0;
 
 public Q_SLOTS:
-    virtual void onCompositorSwappedBuffers() = 0;
+    virtual void onCompositorSwappedBuffers(qintptr userId) = 0;
 
     virtual void setShellChrome(Mir::ShellChrome shellChrome) = 0;
 
@@ -121,6 +160,8 @@ Q_SIGNALS:
     void framesPosted();
     void isBeingDisplayedChanged();
     void frameDropped();
+    void snapshotChanged();
+    void frameCaptureRequested();
 };
 
 } // namespace qtmir
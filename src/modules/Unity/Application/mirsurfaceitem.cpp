@@ -17,22 +17,34 @@
 // local
 #include "application.h"
 #include "session.h"
+#include "mirbuffersgtexture.h"
 #include "mirsurfaceitem.h"
+#include "mirsurfacenode.h"
+#include "surfacethumbnail.h"
 #include "logging.h"
 #include "tracepoints.h" // generated from tracepoints.tp
 #include "timestamp.h"
 
+// mirserver
+#include "capturering.h"
+#include "framereadback.h"
+
 // common
 #include <debughelpers.h>
+#include <directscanoutinterface.h>
 
 // Qt
 #include <QDebug>
 #include <QGuiApplication>
 #include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPointer>
 #include <QQmlEngine>
 #include <QQuickWindow>
 #include <QScreen>
-#include <private/qsgdefaultimagenode_p.h>
+#include <private/qquickitem_p.h>
+#include <qpa/qplatformnativeinterface.h>
 #include <QTimer>
 #include <QSGTextureProvider>
 
@@ -53,6 +65,24 @@ public:
     QObject *textureProvider;
 };
 
+// Whether anything in the item's subtree gets drawn inside the given scene rect
+bool drawsInside(QQuickItem *item, const QRectF &sceneRect)
+{
+    if (!item->isVisible() || item->opacity() <= 0) {
+        return false;
+    }
+    if ((item->flags() & QQuickItem::ItemHasContents)
+            && item->mapRectToScene(item->boundingRect()).intersects(sceneRect)) {
+        return true;
+    }
+    Q_FOREACH(QQuickItem *child, item->childItems()) {
+        if (drawsInside(child, sceneRect)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace {
 
 class MirTextureProvider : public QSGTextureProvider
@@ -60,26 +90,93 @@ class MirTextureProvider : public QSGTextureProvider
     Q_OBJECT
 public:
     MirTextureProvider(const QSharedPointer<QSGTexture>& texture) : t(texture) {}
+    ~MirTextureProvider() { delete snapshot; delete frameReadback; }
+
+    // What the item shows: the snapshot standing in for the surface, the thumbnail, or else the surface texture
     QSGTexture *texture() const {
+        if (snapshot) {
+            snapshot->setFiltering(smooth ? QSGTexture::Linear : QSGTexture::Nearest);
+            return snapshot;
+        }
+        if (thumbnail) {
+            thumbnail->setFiltering(smooth ? QSGTexture::Linear : QSGTexture::Nearest);
+            thumbnail->setMipmapFiltering(thumbnail->hasMipmaps() && smooth ? QSGTexture::Linear : QSGTexture::None);
+            return thumbnail.data();
+        }
+        return surfaceTexture();
+    }
+
+    QSGTexture *surfaceTexture() const {
         if (t)
             t->setFiltering(smooth ? QSGTexture::Linear : QSGTexture::Nearest);
         return t.data();
     }
 
     bool smooth{false};
+    QSharedPointer<SurfaceThumbnail> thumbnail; // shared with the other views of the surface
+    unsigned int thumbnailFrameNumber{0}; // last one textureChanged() got emitted for
+    bool thumbnailUpdateScheduled{false};
+    QSGTexture *snapshot{nullptr};
+    FrameReadback *frameReadback{nullptr};
+
+    // Last frame of the surface, read back for it to show while its client is suspended
+    bool snapshotReadPending{false};
+    QImage readSnapshot;
+    quint64 textureGeneration{0}; // so that reads of another surface's texture get dropped
 
     void releaseTexture() {
         t.reset();
+        thumbnail.reset();
     }
 
     void setTexture(const QSharedPointer<QSGTexture>& newTexture) {
         t = newTexture;
+        thumbnail.reset();
+        textureGeneration++;
+        snapshotReadPending = false;
+        readSnapshot = QImage();
+    }
+
+    // Called from the render thread once a snapshot got read back, with a null image if that failed
+    void snapshotRead(quint64 generation, const QImage &image) {
+        if (generation != textureGeneration) {
+            return;
+        }
+        snapshotReadPending = false;
+        readSnapshot = image;
+        Q_EMIT snapshotReadBack();
+    }
+
+    // Hands over the frames done reading back, asking for another poll while reads are still in flight
+    void collectFrameReadback() {
+        if (frameReadback && frameReadback->collect()) {
+            Q_EMIT frameReadbackPending();
+        }
     }
 
+Q_SIGNALS:
+    void frameReadbackPending();
+    void snapshotReadBack();
+
 private:
     QSharedPointer<QSGTexture> t;
 };
 
+class MirSurfaceItemCollectFrameReadbackJob : public QRunnable
+{
+public:
+    explicit MirSurfaceItemCollectFrameReadbackJob(MirTextureProvider *textureProvider)
+        : textureProvider(textureProvider) {}
+    void run() override {
+        if (textureProvider) {
+            textureProvider->collectFrameReadback();
+        }
+    }
+
+    // Deleted by the render thread as well, so it can't go away while the job runs
+    const QPointer<MirTextureProvider> textureProvider;
+};
+
 MirSurfaceItem::MirSurfaceItem(QQuickItem *parent)
     : MirSurfaceItemInterface(parent)
     , m_surface(nullptr)
@@ -87,11 +184,13 @@ MirSurfaceItem::MirSurfaceItem(QQuickItem *parent)
     , m_textureProvider(nullptr)
     , m_lastTouchEvent(nullptr)
     , m_lastFrameNumberRendered(nullptr)
+    , m_framesPending(false)
     , m_surfaceWidth(0)
     , m_surfaceHeight(0)
     , m_orientationAngle(nullptr)
     , m_consumesInput(false)
     , m_fillMode(Stretch)
+    , m_thumbnailMipmap(false)
 {
     qCDebug(QTMIR_SURFACES) << "MirSurfaceItem::MirSurfaceItem";
 
@@ -102,6 +201,9 @@ MirSurfaceItem::MirSurfaceItem(QQuickItem *parent)
     m_updateMirSurfaceSizeTimer.setInterval(1);
     connect(&m_updateMirSurfaceSizeTimer, &QTimer::timeout, this, &MirSurfaceItem::updateMirSurfaceSize);
 
+    m_readbackPollTimer.setSingleShot(true);
+    connect(&m_readbackPollTimer, &QTimer::timeout, this, &MirSurfaceItem::pollFrameReadback);
+
     connect(this, &QQuickItem::activeFocusChanged, this, &MirSurfaceItem::updateMirSurfaceActiveFocus);
     connect(this, &QQuickItem::visibleChanged, this, &MirSurfaceItem::updateMirSurfaceExposure);
     connect(this, &QQuickItem::windowChanged, this, &MirSurfaceItem::onWindowChanged);
@@ -193,8 +295,21 @@ void MirSurfaceItem::ensureTextureProvider()
         return;
     }
 
+    // Each QQuickWindow (one per Screen) consumes the surface buffers as a compositor of its own
+    const qintptr userId = (qintptr)window();
+
+    // The snapshot standing in for a suspended client is there so that its buffers can be let go
+    const bool showsSnapshot = m_surface->showsSnapshot();
+
     if (!m_textureProvider) {
-        m_textureProvider = new MirTextureProvider(m_surface->texture());
+        m_textureProvider = new MirTextureProvider(showsSnapshot ? QSharedPointer<QSGTexture>()
+                                                                 : m_surface->texture(userId));
+        connect(m_textureProvider, &MirTextureProvider::frameReadbackPending,
+                this, &MirSurfaceItem::scheduleFrameReadbackPoll, Qt::QueuedConnection);
+        connect(m_textureProvider, &MirTextureProvider::snapshotReadBack,
+                this, &QQuickItem::update, Qt::QueuedConnection);
+    } else if (showsSnapshot) {
+        m_textureProvider->releaseTexture();
 
     // Check that the item is indeed using the texture from the MirSurface it currently holds
     // If until now we were drawing a MirSurface "A" and it replaced with a MirSurface "B",
@@ -202,9 +317,9 @@ void MirSurfaceItem::ensureTextureProvider()
     // That's the moment when we finally discard the texture from "A" and get the one from "B".
     //
     // Also note that m_surface->weakTexture() will return null if m_surface->texture() was never
-    // called before.
-    } else if (!m_textureProvider->texture() || m_textureProvider->texture() != m_surface->weakTexture()) {
-        m_textureProvider->setTexture(m_surface->texture());
+    // called before. Same goes for when this item moved to a different window.
+    } else if (!m_textureProvider->surfaceTexture() || m_textureProvider->surfaceTexture() != m_surface->weakTexture(userId)) {
+        m_textureProvider->setTexture(m_surface->texture(userId));
     }
 }
 
@@ -222,32 +337,47 @@ QSGNode *MirSurfaceItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *
 
     ensureTextureProvider();
 
-    if (!m_textureProvider->texture() || !m_surface->updateTexture()) {
+    const qintptr userId = (qintptr)window();
+
+    // Read back by an earlier frame. Ignored unless the surface still wants it.
+    if (!m_textureProvider->readSnapshot.isNull()) {
+        m_surface->setSnapshot(m_textureProvider->readSnapshot);
+        m_textureProvider->readSnapshot = QImage();
+    }
+
+    if (m_surface->showsSnapshot()) {
+        return updateSnapshotNode(oldNode);
+    } else if (m_textureProvider->snapshot) {
+        delete m_textureProvider->snapshot;
+        m_textureProvider->snapshot = nullptr;
+        Q_EMIT m_textureProvider->textureChanged();
+    }
+
+    if (!m_textureProvider->surfaceTexture() || !m_surface->updateTexture(userId)) {
         delete oldNode;
         return 0;
     }
 
-    if (m_surface->numBuffersReadyForCompositor() > 0) {
+    if (m_surface->numBuffersReadyForCompositor(userId) > 0) {
         QTimer::singleShot(0, this, &MirSurfaceItem::update);
     }
 
     m_textureProvider->smooth = smooth();
+    updateFrameCaptures();
+    updateThumbnail(userId);
 
-    QSGDefaultImageNode *node = static_cast<QSGDefaultImageNode*>(oldNode);
+    MirSurfaceNode *node = static_cast<MirSurfaceNode*>(oldNode);
     if (!node) {
-        node = new QSGDefaultImageNode;
-        node->setMipmapFiltering(QSGTexture::None);
-        node->setHorizontalWrapMode(QSGTexture::ClampToEdge);
-        node->setVerticalWrapMode(QSGTexture::ClampToEdge);
+        node = new MirSurfaceNode;
     } else {
-        if (!m_lastFrameNumberRendered  || (*m_lastFrameNumberRendered != m_surface->currentFrameNumber())) {
+        if (!m_lastFrameNumberRendered  || (*m_lastFrameNumberRendered != m_surface->currentFrameNumber(userId))) {
             node->markDirty(QSGNode::DirtyMaterial);
         }
     }
     node->setTexture(m_textureProvider->texture());
 
     if (m_fillMode == PadOrCrop) {
-        const QSize &textureSize = m_textureProvider->texture()->textureSize();
+        const QSize &textureSize = m_textureProvider->surfaceTexture()->textureSize();
 
         QRectF targetRect;
         targetRect.setWidth(qMin(width(), static_cast<qreal>(textureSize.width())));
@@ -255,15 +385,10 @@ QSGNode *MirSurfaceItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *
 
         qreal u = targetRect.width() / textureSize.width();
         qreal v = targetRect.height() / textureSize.height();
-        node->setSubSourceRect(QRectF(0, 0, u, v));
-
-        node->setTargetRect(targetRect);
-        node->setInnerTargetRect(targetRect);
+        node->setRect(targetRect, QRectF(0, 0, u, v));
     } else {
         // Stretch
-        node->setSubSourceRect(QRectF(0, 0, 1, 1));
-        node->setTargetRect(QRectF(0, 0, width(), height()));
-        node->setInnerTargetRect(QRectF(0, 0, width(), height()));
+        node->setRect(QRectF(0, 0, width(), height()), QRectF(0, 0, 1, 1));
     }
 
     node->setFiltering(smooth() ? QSGTexture::Linear : QSGTexture::Nearest);
@@ -274,7 +399,128 @@ QSGNode *MirSurfaceItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *
     if (!m_lastFrameNumberRendered) {
         m_lastFrameNumberRendered = new unsigned int;
     }
-    *m_lastFrameNumberRendered = m_surface->currentFrameNumber();
+    *m_lastFrameNumberRendered = m_surface->currentFrameNumber(userId);
+
+    return node;
+}
+
+// Called from the rendering thread, with m_mutex locked and the surface texture up to date
+void MirSurfaceItem::updateFrameCaptures()
+{
+    m_textureProvider->collectFrameReadback();
+    FrameReadback *&frameReadback = m_textureProvider->frameReadback;
+
+    const QList<FrameHandler> handlers = m_surface->takeFrameCaptures();
+    QList<FrameHandler> frameHandlers = handlers;
+
+    // The snapshot of the last frame gets read back like any capture, so the render thread doesn't wait on it
+    bool readingSnapshot = false;
+    if (m_surface->wantsSnapshot() && !m_textureProvider->snapshotReadPending) {
+        MirTextureProvider *textureProvider = m_textureProvider; // outlives its frameReadback
+        const quint64 generation = textureProvider->textureGeneration;
+        frameHandlers.append([textureProvider, generation](const std::shared_ptr<const CapturedFrame> &frame) {
+            textureProvider->snapshotRead(generation, frame ? frameImage(*frame).copy() : QImage());
+        });
+        textureProvider->snapshotReadPending = true;
+        readingSnapshot = true;
+    }
+
+    if (frameHandlers.isEmpty()) {
+        return;
+    }
+
+    if (!frameReadback) {
+        frameReadback = new FrameReadback(std::make_shared<CaptureRing>());
+    }
+
+    QSGTexture *texture = m_textureProvider->surfaceTexture();
+    texture->bind();
+
+    // Reads the texture itself rather than the window, so what's around or over the item doesn't matter
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    GLint previousFramebuffer = 0;
+    gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    GLuint framebuffer = 0;
+    gl->glGenFramebuffers(1, &framebuffer);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureId(), 0);
+
+    bool read = false;
+    bool refused = false;
+    if (gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+        read = frameReadback->read(texture->textureSize(),
+            texture->hasAlphaChannel() ? QImage::Format_RGBA8888 : QImage::Format_RGBX8888,
+            false /* bottomUp */,
+            [frameHandlers](const std::shared_ptr<const CapturedFrame> &frame) {
+                Q_FOREACH (const FrameHandler &handler, frameHandlers) {
+                    handler(frame);
+                }
+            });
+        refused = !read;
+    }
+
+    if (!read && readingSnapshot) {
+        // Tried again with a later frame
+        m_textureProvider->snapshotReadPending = false;
+    }
+
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    gl->glDeleteFramebuffers(1, &framebuffer);
+
+    if (read) {
+        // Collected by a later frame, or else by polling in between frames
+        Q_EMIT m_textureProvider->frameReadbackPending();
+    } else if (refused) {
+        // Too many reads in flight already, try again with a later frame
+        Q_FOREACH (const FrameHandler &handler, handlers) {
+            m_surface->captureNextFrame(handler);
+        }
+    } else {
+        Q_FOREACH (const FrameHandler &handler, handlers) {
+            handler(nullptr);
+        }
+    }
+}
+
+// Called from the rendering thread, with m_mutex locked, while the surface shows a snapshot of its last frame
+QSGNode *MirSurfaceItem::updateSnapshotNode(QSGNode *oldNode)
+{
+    // Lets go of the surface buffers, GL textures included
+    m_textureProvider->releaseTexture();
+
+    if (!m_textureProvider->snapshot) {
+        const QImage image = m_surface->snapshot();
+        if (image.isNull()) {
+            delete oldNode;
+            return 0;
+        }
+        m_textureProvider->snapshot = window()->createTextureFromImage(image);
+        Q_EMIT m_textureProvider->textureChanged();
+    }
+
+    m_textureProvider->smooth = smooth();
+
+    MirSurfaceNode *node = static_cast<MirSurfaceNode*>(oldNode);
+    if (!node) {
+        node = new MirSurfaceNode;
+    }
+    node->setTexture(m_textureProvider->texture());
+
+    if (m_fillMode == PadOrCrop) {
+        const QSize &textureSize = m_textureProvider->snapshot->textureSize();
+        const QRectF targetRect(0, 0, qMin(width(), static_cast<qreal>(textureSize.width())),
+                                qMin(height(), static_cast<qreal>(textureSize.height())));
+        node->setRect(targetRect, QRectF(0, 0, targetRect.width() / textureSize.width(),
+                                         targetRect.height() / textureSize.height()));
+    } else {
+        node->setRect(QRectF(0, 0, width(), height()), QRectF(0, 0, 1, 1));
+    }
+
+    node->setFiltering(smooth() ? QSGTexture::Linear : QSGTexture::Nearest);
+    node->setAntialiasing(antialiasing());
+
+    node->update();
 
     return node;
 }
@@ -521,10 +767,37 @@ void MirSurfaceItem::updateMirSurfaceActiveFocus()
 
 void MirSurfaceItem::invalidateSceneGraph()
 {
+    QMutexLocker mutexLocker(&m_mutex);
     delete m_textureProvider;
     m_textureProvider = nullptr;
 }
 
+// Called from the GUI thread, as reads back got queued from the render thread
+void MirSurfaceItem::scheduleFrameReadbackPoll()
+{
+    if (m_readbackPollTimer.isActive() || !window()) {
+        return;
+    }
+
+    const qreal refreshRate = window()->screen() ? window()->screen()->refreshRate() : 0;
+    m_readbackPollTimer.start(refreshRate > 0 ? qMax(1, qRound(1000 / refreshRate)) : 16);
+}
+
+// Called from the GUI thread, once no frame came to collect reads back
+void MirSurfaceItem::pollFrameReadback()
+{
+    // Jobs for windows not exposed get dropped. Their reads are left for their next frame.
+    if (!window() || !window()->isExposed()) {
+        return;
+    }
+
+    QMutexLocker mutexLocker(&m_mutex);
+    if (m_textureProvider) {
+        window()->scheduleRenderJob(new MirSurfaceItemCollectFrameReadbackJob(m_textureProvider),
+                                    QQuickWindow::NoStage);
+    }
+}
+
 void MirSurfaceItem::TouchEvent::updateTouchPointStatesAndType()
 {
     touchPointStates = 0;
@@ -598,7 +871,9 @@ void MirSurfaceItem::setSurface(unity::shell::application::MirSurfaceInterface *
 
         // When a new mir frame gets posted we notify the QML engine that this item needs redrawing,
         // schedules call to updatePaintNode() from the rendering thread
-        connect(m_surface, &MirSurfaceInterface::framesPosted, this, &QQuickItem::update);
+        connect(m_surface, &MirSurfaceInterface::framesPosted, this, &MirSurfaceItem::onFramesPosted);
+        connect(m_surface, &MirSurfaceInterface::snapshotChanged, this, &QQuickItem::update);
+        connect(m_surface, &MirSurfaceInterface::frameCaptureRequested, this, &QQuickItem::update);
 
         connect(m_surface, &MirSurfaceInterface::stateChanged, this, &MirSurfaceItem::surfaceStateChanged);
         connect(m_surface, &MirSurfaceInterface::liveChanged, this, &MirSurfaceItem::liveChanged);
@@ -640,10 +915,143 @@ void MirSurfaceItem::setSurface(unity::shell::application::MirSurfaceInterface *
 void MirSurfaceItem::onCompositorSwappedBuffers()
 {
     if (Q_LIKELY(m_surface)) {
-        m_surface->onCompositorSwappedBuffers();
+        m_surface->onCompositorSwappedBuffers((qintptr)window());
     }
 }
 
+void MirSurfaceItem::onFramesPosted()
+{
+    // Each repaint redraws the whole window, so don't trigger one for frames which wouldn't show up
+    // in it. They get consumed by the first repaint once they would, or dropped by the surface.
+    if (framesDamageWindow()) {
+        m_framesPending = false;
+        update();
+    } else {
+        m_framesPending = true;
+    }
+}
+
+// Called from the GUI thread right before the window gets polished and synchronized for a new frame
+void MirSurfaceItem::onWindowAnimated()
+{
+    if (m_framesPending && framesDamageWindow()) {
+        m_framesPending = false;
+        update();
+    }
+}
+
+// Whether new surface frames would change anything in the window
+bool MirSurfaceItem::framesDamageWindow() const
+{
+    if (!window() || !isVisible()) {
+        return false;
+    }
+
+    // The content of this item is rendered elsewhere as well, e.g. by a ShaderEffectSource
+    QQuickItemPrivate *itemPrivate = QQuickItemPrivate::get(const_cast<MirSurfaceItem*>(this));
+    if (itemPrivate->extra.isAllocated() && itemPrivate->extra->effectRefCount > 0) {
+        return true;
+    }
+
+    for (const QQuickItem *item = this; item; item = item->parentItem()) {
+        if (item->opacity() <= 0) {
+            return false;
+        }
+    }
+
+    const QRectF windowRect(QPointF(0, 0), window()->size());
+    return mapRectToScene(boundingRect()).intersects(windowRect);
+}
+
+// Called from the rendering thread once the scene graph got synchronized, so with the GUI thread blocked
+void MirSurfaceItem::updateDirectScanout()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    auto node = static_cast<MirSurfaceNode*>(QQuickItemPrivate::get(this)->paintNode);
+    if (!node) {
+        return;
+    }
+
+    bool offered = false;
+    bool scannedOut = false;
+    auto texture = m_textureProvider ? qobject_cast<MirBufferSGTexture*>(m_textureProvider->surfaceTexture()) : nullptr;
+
+    if (texture && texture->hasBuffer() && !texture->hasAlphaChannel() && coversWindowUnobstructed()) {
+        auto directScanout = static_cast<DirectScanoutInterface*>(
+                QGuiApplication::platformNativeInterface()->nativeResourceForWindow("DirectScanout", window()));
+        if (directScanout) {
+            // The display decides once, before the frame gets rendered, whether it scans the buffer
+            // out. Only then is the buffer left out of the frame.
+            const auto buffer = texture->buffer();
+            scannedOut = directScanout->offerScanoutBuffer(buffer, m_offeredScanoutBuffer.lock());
+            m_offeredScanoutBuffer = buffer;
+            offered = true;
+        }
+    }
+
+    if (!offered) {
+        m_offeredScanoutBuffer.reset();
+    }
+
+    node->setScannedOut(scannedOut);
+}
+
+// Whether this item is shown 1:1 over the whole window, fully opaque and with nothing drawn on top
+bool MirSurfaceItem::coversWindowUnobstructed() const
+{
+    if (!isVisible()) {
+        return false;
+    }
+
+    const QRectF windowRect(QPointF(0, 0), window()->size());
+    if (mapToScene(QPointF(0, 0)) != windowRect.topLeft()
+            || mapToScene(QPointF(width(), 0)) != windowRect.topRight()
+            || mapToScene(QPointF(0, height())) != windowRect.bottomLeft()) {
+        return false;
+    }
+
+    Q_FOREACH(QQuickItem *child, childItems()) {
+        if (drawsInside(child, windowRect)) {
+            return false;
+        }
+    }
+
+    const QQuickItem *item = this;
+    while (item) {
+        if (item->opacity() < 1.0) {
+            return false;
+        }
+
+        // Rendered into an offscreen texture rather than straight into the window
+        QQuickItemPrivate *itemPrivate = QQuickItemPrivate::get(const_cast<QQuickItem*>(item));
+        if (itemPrivate->extra.isAllocated() && itemPrivate->extra->layer && itemPrivate->extra->layer->enabled()) {
+            return false;
+        }
+
+        QQuickItem *parent = item->parentItem();
+        if (!parent) {
+            break;
+        }
+
+        if (parent->clip() && !parent->mapRectToScene(parent->boundingRect()).contains(windowRect)) {
+            return false;
+        }
+
+        // Whatever comes after us in the paint order gets drawn on top
+        const QList<QQuickItem *> siblings = QQuickItemPrivate::get(parent)->paintOrderChildItems();
+        for (int i = siblings.indexOf(const_cast<QQuickItem*>(item)) + 1; i < siblings.count(); ++i) {
+            if (drawsInside(siblings[i], windowRect)) {
+                return false;
+            }
+        }
+
+        item = parent;
+    }
+
+    return true;
+}
+
 void MirSurfaceItem::onWindowChanged(QQuickWindow *window)
 {
     if (m_window) {
@@ -653,6 +1061,9 @@ void MirSurfaceItem::onWindowChanged(QQuickWindow *window)
     if (m_window) {
         connect(m_window, &QQuickWindow::frameSwapped, this, &MirSurfaceItem::onCompositorSwappedBuffers,
                 Qt::DirectConnection);
+        connect(m_window, &QQuickWindow::afterSynchronizing, this, &MirSurfaceItem::updateDirectScanout,
+                Qt::DirectConnection);
+        connect(m_window, &QQuickWindow::afterAnimating, this, &MirSurfaceItem::onWindowAnimated);
     }
 }
 
@@ -714,6 +1125,63 @@ void MirSurfaceItem::setFillMode(FillMode value)
     }
 }
 
+void MirSurfaceItem::setThumbnailSize(const QSize &size)
+{
+    if (m_thumbnailSize != size) {
+        m_thumbnailSize = size;
+        update();
+        Q_EMIT thumbnailSizeChanged(m_thumbnailSize);
+    }
+}
+
+void MirSurfaceItem::setThumbnailMipmap(bool mipmap)
+{
+    if (m_thumbnailMipmap != mipmap) {
+        m_thumbnailMipmap = mipmap;
+        update();
+        Q_EMIT thumbnailMipmapChanged(m_thumbnailMipmap);
+    }
+}
+
+// Called from the rendering thread, with m_mutex locked and the GUI thread blocked
+void MirSurfaceItem::updateThumbnail(qintptr userId)
+{
+    if (m_thumbnailSize.isEmpty()) {
+        if (m_textureProvider->thumbnail) {
+            m_textureProvider->thumbnail.reset();
+            Q_EMIT m_textureProvider->textureChanged();
+        }
+        return;
+    }
+
+    auto thumbnail = m_surface->thumbnail(userId, m_thumbnailSize, m_thumbnailMipmap);
+    if (thumbnail != m_textureProvider->thumbnail) {
+        m_textureProvider->thumbnail = thumbnail;
+        m_textureProvider->thumbnailFrameNumber = thumbnail->frameNumber();
+        m_textureProvider->thumbnailUpdateScheduled = false;
+        Q_EMIT m_textureProvider->textureChanged();
+    }
+
+    // Another view of the surface might have drawn the frame into the thumbnail already
+    const unsigned int frameNumber = m_surface->currentFrameNumber(userId);
+    const int msecs = thumbnail->msecsUntilUpdate(frameNumber);
+    if (msecs == 0) {
+        thumbnail->update(m_textureProvider->surfaceTexture(), frameNumber);
+    }
+    if (msecs <= 0) {
+        m_textureProvider->thumbnailUpdateScheduled = false;
+    } else if (!m_textureProvider->thumbnailUpdateScheduled) {
+        // Come back for the frame held back, in case the client doesn't post another one
+        m_textureProvider->thumbnailUpdateScheduled = true;
+        QTimer::singleShot(msecs, this, &MirSurfaceItem::update);
+    }
+
+    if (thumbnail->frameNumber() != m_textureProvider->thumbnailFrameNumber) {
+        m_textureProvider->thumbnailFrameNumber = thumbnail->frameNumber();
+        Q_EMIT m_textureProvider->textureChanged();
+    }
+}
+
 } // namespace qtmir
 
 #include "mirsurfaceitem.moc"
@@ -29,15 +29,22 @@
 #include "mirsurfaceinterface.h"
 #include "session_interface.h"
 
+namespace mir { namespace graphics { class Buffer; }}
+
 namespace qtmir {
 
-class QSGMirSurfaceNode;
 class MirTextureProvider;
 
 class MirSurfaceItem : public unity::shell::application::MirSurfaceItemInterface
 {
     Q_OBJECT
 
+    // When valid, the item draws and provides a copy of the surface downscaled to that size, refreshed at
+    // a bounded rate, instead of the surface itself. Meant for items showing surfaces much smaller than
+    // they are, like in a spread or an app switcher.
+    Q_PROPERTY(QSize thumbnailSize READ thumbnailSize WRITE setThumbnailSize NOTIFY thumbnailSizeChanged)
+    Q_PROPERTY(bool thumbnailMipmap READ thumbnailMipmap WRITE setThumbnailMipmap NOTIFY thumbnailMipmapChanged)
+
 public:
     explicit MirSurfaceItem(QQuickItem *parent = 0);
     virtual ~MirSurfaceItem();
@@ -79,6 +86,12 @@ public:
     ////////
     // own API
 
+    QSize thumbnailSize() const { return m_thumbnailSize; }
+    void setThumbnailSize(const QSize &size);
+
+    bool thumbnailMipmap() const { return m_thumbnailMipmap; }
+    void setThumbnailMipmap(bool mipmap);
+
     // to allow easy touch event injection from tests
     bool processTouchEvent(int eventType,
             ulong timestamp,
@@ -87,6 +100,10 @@ public:
             Qt::TouchPointStates touchPointStates);
 
 
+Q_SIGNALS:
+    void thumbnailSizeChanged(const QSize &size);
+    void thumbnailMipmapChanged(bool mipmap);
+
 public Q_SLOTS:
     // Called by QQuickWindow from the rendering thread
     void invalidateSceneGraph();
@@ -118,11 +135,23 @@ private Q_SLOTS:
 
     void onActualSurfaceSizeChanged(QSize size);
     void onCompositorSwappedBuffers();
+    void updateDirectScanout();
+
+    void onFramesPosted();
+    void onWindowAnimated();
 
     void onWindowChanged(QQuickWindow *window);
 
+    void scheduleFrameReadbackPoll();
+    void pollFrameReadback();
+
 private:
     void ensureTextureProvider();
+    void updateThumbnail(qintptr userId);
+    QSGNode *updateSnapshotNode(QSGNode *oldNode);
+    void updateFrameCaptures();
+    bool coversWindowUnobstructed() const;
+    bool framesDamageWindow() const;
 
     bool hasTouchInsideInputRegion(const QList<QTouchEvent::TouchPoint> &touchPoints);
 
@@ -139,9 +168,13 @@ private:
 
     QMutex m_mutex;
     MirTextureProvider *m_textureProvider;
+    std::weak_ptr<mir::graphics::Buffer> m_offeredScanoutBuffer; // only touched by the render thread
 
     QTimer m_updateMirSurfaceSizeTimer;
 
+    // Has the render thread collect surface reads back in between frames, rather than forcing frames
+    QTimer m_readbackPollTimer;
+
     class TouchEvent {
     public:
         TouchEvent &operator= (const QTouchEvent &qtEvent) {
@@ -164,6 +197,9 @@ private:
 
     unsigned int *m_lastFrameNumberRendered;
 
+    // Frames got posted while they wouldn't have shown up in the window
+    bool m_framesPending;
+
     int m_surfaceWidth;
     int m_surfaceHeight;
     Mir::OrientationAngle *m_orientationAngle;
@@ -171,6 +207,9 @@ private:
     bool m_consumesInput;
 
     FillMode m_fillMode;
+
+    QSize m_thumbnailSize;
+    bool m_thumbnailMipmap;
 };
 
 } // namespace qtmir
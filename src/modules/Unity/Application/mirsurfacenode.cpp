@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mirsurfacenode.h"
+
+MirSurfaceNode::MirSurfaceNode()
+{
+    setMipmapFiltering(QSGTexture::None);
+    setHorizontalWrapMode(QSGTexture::ClampToEdge);
+    setVerticalWrapMode(QSGTexture::ClampToEdge);
+}
+
+void MirSurfaceNode::setRect(const QRectF &targetRect, const QRectF &sourceRect)
+{
+    setTargetRect(targetRect);
+    setInnerTargetRect(targetRect);
+    setSubSourceRect(sourceRect);
+}
+
+void MirSurfaceNode::setScannedOut(bool scannedOut)
+{
+    if (m_scannedOut != scannedOut) {
+        m_scannedOut = scannedOut;
+        markDirty(DirtySubtreeBlocked);
+    }
+}
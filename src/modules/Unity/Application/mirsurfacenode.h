@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRSURFACENODE_H
+#define MIRSURFACENODE_H
+
+#include <QRectF>
+#include <private/qsgdefaultimagenode_p.h>
+
+// Draws the buffer of a Mir surface the way the default image node draws images
+class MirSurfaceNode : public QSGDefaultImageNode
+{
+public:
+    MirSurfaceNode();
+
+    // sourceRect is in normalized texture coordinates. Takes effect with update().
+    void setRect(const QRectF &targetRect, const QRectF &sourceRect);
+
+    // Stays out of the rendered frame while the display scans its buffer out directly
+    void setScannedOut(bool scannedOut);
+    bool isSubtreeBlocked() const override { return m_scannedOut; }
+
+private:
+    bool m_scannedOut{false};
+};
+
+#endif // MIRSURFACENODE_H
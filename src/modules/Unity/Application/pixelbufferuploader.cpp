@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "pixelbufferuploader.h"
+
+#include "miral/mirbuffer.h"
+
+// Qt
+#include <QOpenGLContext>
+#include <QRunnable>
+#include <QThreadPool>
+
+// std
+#include <cstring>
+
+#ifndef GL_BGRA_EXT
+#define GL_BGRA_EXT 0x80E1
+#endif
+
+namespace {
+
+bool contextSupportsPixelBuffers(QOpenGLContext *context)
+{
+    if (!context) {
+        return false;
+    }
+    if (context->isOpenGLES()) {
+        return context->format().majorVersion() >= 3;
+    }
+    return context->format().version() >= qMakePair(2, 1)
+        || context->hasExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"));
+}
+
+// Format matching the in-memory byte order of 32 bit Mir pixel formats on little endian machines
+bool glFormatFromMirPixelFormat(QOpenGLContext *context, MirPixelFormat pixelFormat, GLenum *format)
+{
+    switch (pixelFormat) {
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        *format = GL_RGBA;
+        return true;
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        if (context->isOpenGLES() && !context->hasExtension(QByteArrayLiteral("GL_EXT_texture_format_BGRA8888"))) {
+            return false;
+        }
+        *format = GL_BGRA_EXT;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool uploadFormat(miral::GLBuffer &buffer, GLenum *format)
+{
+    if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN) {
+        return false;
+    }
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    return contextSupportsPixelBuffers(context) && glFormatFromMirPixelFormat(context, buffer.pixel_format(), format);
+}
+
+QSize bufferSize(miral::GLBuffer &buffer)
+{
+    return QSize(buffer.size().width.as_int(), buffer.size().height.as_int());
+}
+
+// Thread-agnostic, destination being mapped pixel buffer storage. Returns false for buffers living on the GPU
+bool copyPixels(miral::GLBuffer &buffer, const QSize &size, unsigned char *destination)
+{
+    const int rowLength = size.width() * 4;
+
+    return buffer.read_pixels([&](unsigned char const* pixels, mir::geometry::Stride stride) {
+        // Tightly packed in the pixel buffer, so no unpack row length is needed
+        if (stride.as_int() == rowLength) {
+            memcpy(destination, pixels, rowLength * size.height());
+        } else {
+            for (int row = 0; row < size.height(); ++row) {
+                memcpy(destination + row * rowLength, pixels + row * stride.as_int(), rowLength);
+            }
+        }
+    });
+}
+
+class CopyPixelsJob : public QRunnable
+{
+public:
+    CopyPixelsJob(const std::shared_ptr<mir::graphics::Buffer> &buffer, const QSize &size, unsigned char *destination)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_destination(destination)
+    {}
+
+    std::future<bool> copied() { return m_copied.get_future(); }
+
+    void run() override
+    {
+        miral::GLBuffer buffer(m_buffer);
+        m_copied.set_value(copyPixels(buffer, m_size, m_destination));
+    }
+
+private:
+    const std::shared_ptr<mir::graphics::Buffer> m_buffer;
+    const QSize m_size;
+    unsigned char *const m_destination;
+    std::promise<bool> m_copied;
+};
+
+// Kept apart from the global pool, so that copies needed for the frame being rendered never queue
+// behind slow jobs such as snapshot compression
+Q_GLOBAL_STATIC(QThreadPool, copyThreadPool)
+
+} // namespace {
+
+PixelBufferUploader::PixelBufferUploader()
+    : m_pixelBuffers{QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer), QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer)}
+    , m_nextPixelBuffer(0)
+    , m_textureFormat(GL_NONE)
+{
+}
+
+PixelBufferUploader::~PixelBufferUploader()
+{
+    discardPrepared();
+}
+
+bool PixelBufferUploader::prepare(miral::GLBuffer &buffer)
+{
+    discardPrepared();
+    unmapDiscarded();
+
+    GLenum format;
+    if (!buffer.can_read_pixels() || !uploadFormat(buffer, &format)) {
+        return false;
+    }
+
+    const QSize size = bufferSize(buffer);
+    unsigned char *destination = mapNextPixelBuffer(size);
+    if (!destination) {
+        return false;
+    }
+
+    auto job = new CopyPixelsJob(buffer.buffer(), size, destination);
+    m_preparedCopy = job->copied();
+    m_preparedBuffer = buffer.buffer();
+    copyThreadPool()->start(job);
+    return true;
+}
+
+bool PixelBufferUploader::upload(miral::GLBuffer &buffer)
+{
+    GLenum format;
+    if (!uploadFormat(buffer, &format)) {
+        return false;
+    }
+
+    const QSize size = bufferSize(buffer);
+    bool mapped;
+    bool copied;
+
+    if (m_preparedBuffer && m_preparedBuffer == buffer.buffer()) {
+        mapped = true;
+        copied = m_preparedCopy.get();
+        m_preparedBuffer.reset();
+    } else {
+        discardPrepared();
+        unmapDiscarded();
+        unsigned char *destination = mapNextPixelBuffer(size);
+        mapped = destination != nullptr;
+        copied = mapped && copyPixels(buffer, size, destination);
+    }
+
+    return uploadNextPixelBuffer(QOpenGLContext::currentContext(), mapped, copied, size, format);
+}
+
+void PixelBufferUploader::discardPrepared()
+{
+    if (!m_preparedBuffer) {
+        return;
+    }
+
+    m_preparedCopy.wait();
+    m_preparedBuffer.reset();
+
+    // Might be called without the GL context current, so the pixel buffer gets unmapped when next used
+    m_preparedBufferMapped = true;
+}
+
+void PixelBufferUploader::unmapDiscarded()
+{
+    if (m_preparedBufferMapped) {
+        QOpenGLBuffer &pixelBuffer = m_pixelBuffers[m_nextPixelBuffer];
+        pixelBuffer.bind();
+        pixelBuffer.unmap();
+        QOpenGLBuffer::release(QOpenGLBuffer::PixelUnpackBuffer);
+        m_preparedBufferMapped = false;
+    }
+}
+
+unsigned char *PixelBufferUploader::mapNextPixelBuffer(const QSize &size)
+{
+    QOpenGLBuffer &pixelBuffer = m_pixelBuffers[m_nextPixelBuffer];
+    if (!pixelBuffer.isCreated()) {
+        if (!pixelBuffer.create()) {
+            return nullptr;
+        }
+        pixelBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+
+    const int byteCount = size.width() * 4 * size.height();
+
+    pixelBuffer.bind();
+    // Orphans the storage the GPU might still be reading from instead of waiting for it
+    pixelBuffer.allocate(byteCount);
+    auto destination = static_cast<unsigned char*>(
+            pixelBuffer.mapRange(0, byteCount, QOpenGLBuffer::RangeWrite | QOpenGLBuffer::RangeInvalidateBuffer));
+
+    // Leave no pixel unpack buffer bound, or later texture uploads by others would source from it
+    QOpenGLBuffer::release(QOpenGLBuffer::PixelUnpackBuffer);
+
+    return destination;
+}
+
+bool PixelBufferUploader::uploadNextPixelBuffer(QOpenGLContext *context, bool mapped, bool copied,
+                                                const QSize &size, GLenum format)
+{
+    if (!mapped) {
+        return false;
+    }
+
+    QOpenGLBuffer &pixelBuffer = m_pixelBuffers[m_nextPixelBuffer];
+    pixelBuffer.bind();
+    const bool uploaded = pixelBuffer.unmap() && copied;
+
+    if (uploaded) {
+        // Set the unpack state the upload relies on, rather than depending on what was left behind
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (size != m_textureSize || format != m_textureFormat) {
+            const GLint internalFormat = context->isOpenGLES() ? format : GL_RGBA;
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.width(), size.height(), 0,
+                         format, GL_UNSIGNED_BYTE, nullptr);
+            m_textureSize = size;
+            m_textureFormat = format;
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.width(), size.height(),
+                            format, GL_UNSIGNED_BYTE, nullptr);
+        }
+        m_nextPixelBuffer = (m_nextPixelBuffer + 1) % 2;
+    }
+
+    QOpenGLBuffer::release(QOpenGLBuffer::PixelUnpackBuffer);
+
+    return uploaded;
+}
+
+void PixelBufferUploader::textureReplaced()
+{
+    m_textureSize = QSize();
+    m_textureFormat = GL_NONE;
+}
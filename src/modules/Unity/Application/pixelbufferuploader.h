@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PIXELBUFFERUPLOADER_H
+#define PIXELBUFFERUPLOADER_H
+
+#include <QOpenGLBuffer>
+#include <QSize>
+
+#include <QtGui/qopengl.h>
+
+#include <future>
+#include <memory>
+
+namespace miral { class GLBuffer; }
+namespace mir { namespace graphics { class Buffer; }}
+
+class QOpenGLContext;
+
+// Uploads the pixels of shared-memory client buffers into a GL texture through a pair of pixel
+// unpack buffers, used in turns so that filling one never waits for the GPU to be done reading
+// the other. Texture storage is only reallocated when the buffer size or format changes.
+//
+// prepare() has a worker thread copy the pixels into the mapped pixel buffer, while the rendering
+// thread goes on until upload() needs them. Only the copy leaves the rendering thread, as mapped
+// buffer storage is plain memory. Mapping, unmapping and uploading stay with the GL context.
+//
+// Must be used from the thread of the GL context it uploads in, but for discardPrepared().
+class PixelBufferUploader
+{
+public:
+    PixelBufferUploader();
+    ~PixelBufferUploader();
+
+    // Starts copying the pixels of the buffer on a worker thread, for upload() to pick up. Returns
+    // false if the buffer can't be uploaded this way, in which case upload() does so as well.
+    bool prepare(miral::GLBuffer &buffer);
+
+    // Uploads the pixels of the buffer into the texture bound to GL_TEXTURE_2D, waiting for the copy
+    // prepare() started for the buffer if any. Returns false, leaving the texture untouched, if the
+    // buffer can't be uploaded this way: it has no CPU accessible pixels, has an unsupported pixel
+    // format, or the GL context lacks PBO support.
+    bool upload(miral::GLBuffer &buffer);
+
+    // Waits for the copy prepare() started, if any, and lets go of its buffer. Takes no GL, so can be
+    // called from any thread while the uploader is not in use.
+    void discardPrepared();
+
+    // To be called when the texture got its content some other way
+    void textureReplaced();
+
+private:
+    void unmapDiscarded();
+    unsigned char *mapNextPixelBuffer(const QSize &size);
+    bool uploadNextPixelBuffer(QOpenGLContext *context, bool mapped, bool copied, const QSize &size, GLenum format);
+
+    QOpenGLBuffer m_pixelBuffers[2];
+    int m_nextPixelBuffer;
+    QSize m_textureSize;
+    GLenum m_textureFormat;
+
+    // Buffer copied into the next pixel buffer, mapped until upload() picks it up
+    std::shared_ptr<mir::graphics::Buffer> m_preparedBuffer;
+    std::future<bool> m_preparedCopy;
+    bool m_preparedBufferMapped{false}; // the next pixel buffer, left mapped by discardPrepared()
+};
+
+#endif // PIXELBUFFERUPLOADER_H
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "surfacesnapshot.h"
+
+// Qt
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+using namespace qtmir;
+
+struct SurfaceSnapshot::Data
+{
+    mutable QMutex mutex;
+    QImage image; // until compressed, or once decoded back
+    QByteArray compressed;
+    QString filePath;
+    bool decoding{false};
+    quint64 generation{0}; // bumped on every change, so stale compression results get dropped
+};
+
+class SurfaceSnapshot::CompressJob : public QRunnable
+{
+public:
+    CompressJob(const std::shared_ptr<Data> &data, quint64 generation, const QImage &image, const QString &filePath)
+        : m_data(data), m_generation(generation), m_image(image), m_filePath(filePath) {}
+
+    void run() override
+    {
+        QByteArray compressed;
+        QBuffer buffer(&compressed);
+        buffer.open(QIODevice::WriteOnly);
+        if (!m_image.save(&buffer, "PNG")) {
+            return;
+        }
+
+        if (!m_filePath.isEmpty()) {
+            QFile file(m_filePath);
+            if (file.open(QIODevice::WriteOnly) && file.write(compressed) == compressed.size()) {
+                compressed.clear();
+            } else {
+                file.remove();
+            }
+        }
+
+        QMutexLocker locker(&m_data->mutex);
+        if (m_data->generation != m_generation) {
+            if (compressed.isEmpty()) {
+                QFile::remove(m_filePath);
+            }
+            return;
+        }
+
+        m_data->image = QImage();
+        m_data->compressed = compressed;
+        m_data->filePath = compressed.isEmpty() ? m_filePath : QString();
+    }
+
+private:
+    const std::shared_ptr<Data> m_data;
+    const quint64 m_generation;
+    const QImage m_image;
+    const QString m_filePath;
+};
+
+class SurfaceSnapshot::DecodeJob : public QRunnable
+{
+public:
+    DecodeJob(const std::shared_ptr<Data> &data, quint64 generation, const QByteArray &compressed,
+              const QString &filePath, const std::function<void()> &decoded)
+        : m_data(data), m_generation(generation), m_compressed(compressed), m_filePath(filePath), m_decoded(decoded) {}
+
+    void run() override
+    {
+        const QImage image = m_compressed.isEmpty() ? QImage(m_filePath, "PNG")
+                                                    : QImage::fromData(m_compressed, "PNG");
+
+        QMutexLocker locker(&m_data->mutex);
+        if (m_data->generation != m_generation) {
+            return;
+        }
+
+        m_data->decoding = false;
+        if (image.isNull()) {
+            // Gone for good, so don't have it decoded over and over
+            m_data->compressed.clear();
+            if (!m_data->filePath.isEmpty()) {
+                QFile::remove(m_data->filePath);
+                m_data->filePath.clear();
+            }
+        } else {
+            m_data->image = image;
+        }
+
+        // Under the lock, so that clear() can't return while it's running
+        if (m_decoded) {
+            m_decoded();
+        }
+    }
+
+private:
+    const std::shared_ptr<Data> m_data;
+    const quint64 m_generation;
+    const QByteArray m_compressed;
+    const QString m_filePath;
+    const std::function<void()> m_decoded;
+};
+
+SurfaceSnapshot::SurfaceSnapshot()
+    : d(std::make_shared<Data>())
+{
+}
+
+SurfaceSnapshot::~SurfaceSnapshot()
+{
+    clear();
+}
+
+void SurfaceSnapshot::store(const QImage &image, const QString &key)
+{
+    clear();
+
+    QMutexLocker locker(&d->mutex);
+
+    // Named after the generation too, so a late job for an older image can't clobber the file
+    QString filePath;
+    const QString cacheDir = QString::fromLocal8Bit(qgetenv("QTMIR_SNAPSHOT_CACHE_DIR"));
+    if (!cacheDir.isEmpty() && !key.isEmpty() && QDir().mkpath(cacheDir)) {
+        filePath = QDir(cacheDir).filePath(QString("%1-%2.png").arg(key).arg(d->generation));
+    }
+
+    d->image = image;
+    QThreadPool::globalInstance()->start(new CompressJob(d, d->generation, image, filePath));
+}
+
+QImage SurfaceSnapshot::load() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->image;
+}
+
+void SurfaceSnapshot::decode(const std::function<void()> &decoded) const
+{
+    QMutexLocker locker(&d->mutex);
+    if (!d->image.isNull() || d->decoding || (d->compressed.isEmpty() && d->filePath.isEmpty())) {
+        return;
+    }
+
+    d->decoding = true;
+    QThreadPool::globalInstance()->start(new DecodeJob(d, d->generation, d->compressed, d->filePath, decoded));
+}
+
+void SurfaceSnapshot::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    d->generation++;
+    d->decoding = false;
+    d->image = QImage();
+    d->compressed.clear();
+    if (!d->filePath.isEmpty()) {
+        QFile::remove(d->filePath);
+        d->filePath.clear();
+    }
+}
+
+bool SurfaceSnapshot::isEmpty() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->image.isNull() && d->compressed.isEmpty() && d->filePath.isEmpty();
+}
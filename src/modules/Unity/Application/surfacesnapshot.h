@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SURFACESNAPSHOT_H
+#define SURFACESNAPSHOT_H
+
+#include <QImage>
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+namespace qtmir {
+
+// The last frame of a surface, standing in for it while its client is suspended.
+//
+// A stored image gets PNG compressed in the background, and optionally spilled to a file in
+// QTMIR_SNAPSHOT_CACHE_DIR, named after the key it was stored with. Until then the raw image is kept.
+// Getting it back decodes it in the background as well, so no caller ever waits on the PNG.
+//
+// Thread-safe.
+class SurfaceSnapshot
+{
+public:
+    SurfaceSnapshot();
+    ~SurfaceSnapshot();
+
+    void store(const QImage &image, const QString &key);
+    void clear();
+
+    // The image, if it's there already or got decoded back. Null otherwise.
+    QImage load() const;
+
+    // Decodes the image back in the background, unless load() has it already. Calls decoded from the
+    // thread pool once done, unless the snapshot got cleared or stored over in the meantime.
+    void decode(const std::function<void()> &decoded) const;
+
+    bool isEmpty() const;
+
+private:
+    struct Data;
+    class CompressJob;
+    class DecodeJob;
+    const std::shared_ptr<Data> d;
+};
+
+} // namespace qtmir
+
+#endif // SURFACESNAPSHOT_H
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "surfacethumbnail.h"
+
+// mirserver
+#include "framebufferpool.h"
+#include "logging.h"
+#include "nativeinterface.h"
+
+// Qt
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+namespace {
+
+const char *vertexShader =
+    "attribute highp vec2 position;\n"
+    "attribute highp vec2 texCoord;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    v_texCoord = texCoord;\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+const char *fragmentShader =
+    "uniform sampler2D source;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(source, v_texCoord);\n"
+    "}\n";
+
+// Keeps texture coordinates as they are, so the thumbnail has the same orientation as its source
+const GLfloat quad[] = {
+    // position   texCoord
+    -1.0f, -1.0f,  0.0f, 0.0f,
+     1.0f, -1.0f,  1.0f, 0.0f,
+    -1.0f,  1.0f,  0.0f, 1.0f,
+     1.0f,  1.0f,  1.0f, 1.0f,
+};
+
+// Halves the dimensions still over twice the target's. What is left is up to the final, bilinear pass.
+QSize halved(const QSize &size, const QSize &target)
+{
+    return QSize(size.width() > 2 * target.width() ? (size.width() + 1) / 2 : size.width(),
+                 size.height() > 2 * target.height() ? (size.height() + 1) / 2 : size.height());
+}
+
+FramebufferPool *framebufferPool()
+{
+    auto nativeInterface = dynamic_cast<NativeInterface*>(QGuiApplication::platformNativeInterface());
+    if (!nativeInterface) {
+        return nullptr;
+    }
+    return static_cast<FramebufferPool*>(nativeInterface->nativeResourceForIntegration("FramebufferPool"));
+}
+
+} // namespace {
+
+SurfaceThumbnail::SurfaceThumbnail(const QSize &size, bool mipmap)
+    : QSGTexture()
+    , m_pool(framebufferPool())
+    , m_size(size)
+    , m_framebuffer(nullptr)
+    , m_frameNumber(0)
+    , m_requestedMipmap(mipmap)
+    , m_mipmap(false)
+    , m_hasAlphaChannel(true)
+{
+    setFiltering(QSGTexture::Linear);
+    setHorizontalWrapMode(QSGTexture::ClampToEdge);
+    setVerticalWrapMode(QSGTexture::ClampToEdge);
+}
+
+SurfaceThumbnail::~SurfaceThumbnail()
+{
+    if (m_framebuffer) {
+        m_pool->release(m_framebuffer);
+    }
+}
+
+int SurfaceThumbnail::msecsUntilUpdate(unsigned int frameNumber) const
+{
+    // No thumbnail at all can't wait
+    if (!m_framebuffer) {
+        return 0;
+    }
+    if (m_frameNumber == frameNumber) {
+        return -1;
+    }
+    return qMax(0, minimumUpdateInterval - int(m_sinceUpdate.elapsed()));
+}
+
+void SurfaceThumbnail::update(QSGTexture *source, unsigned int frameNumber)
+{
+    if (!m_pool) {
+        qCWarning(QTMIR_SURFACES) << "SurfaceThumbnail::update - no framebuffer pool, needs the mirserver QPA plugin";
+        return;
+    }
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    QOpenGLFunctions *gl = context->functions();
+
+    if (!m_framebuffer) {
+        // Without full NPOT support, mipmaps are only available for power of two sizes
+        m_mipmap = m_requestedMipmap && gl->hasOpenGLFeature(QOpenGLFunctions::NPOTTextures);
+
+        QOpenGLFramebufferObjectFormat format;
+        format.setMipmap(m_mipmap);
+        m_framebuffer = m_pool->acquire(m_size, format);
+        if (!m_framebuffer) {
+            return;
+        }
+    }
+
+    if (!m_program) {
+        m_program.reset(new QOpenGLShaderProgram);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+        m_program->bindAttributeLocation("position", 0);
+        m_program->bindAttributeLocation("texCoord", 1);
+        m_program->link();
+    }
+
+    // We're in the middle of the scene graph's frame, leave GL state as we found it
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    GLint previousProgram = 0;
+    GLint previousArrayBuffer = 0;
+    gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    gl->glGetIntegerv(GL_VIEWPORT, previousViewport);
+    gl->glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    gl->glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+    const bool blend = gl->glIsEnabled(GL_BLEND);
+    const bool depthTest = gl->glIsEnabled(GL_DEPTH_TEST);
+    const bool scissorTest = gl->glIsEnabled(GL_SCISSOR_TEST);
+    const bool stencilTest = gl->glIsEnabled(GL_STENCIL_TEST);
+
+    gl->glDisable(GL_BLEND);
+    gl->glDisable(GL_DEPTH_TEST);
+    gl->glDisable(GL_SCISSOR_TEST);
+    gl->glDisable(GL_STENCIL_TEST);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_program->bind();
+    m_program->setUniformValue("source", 0);
+    gl->glActiveTexture(GL_TEXTURE0);
+    source->setFiltering(QSGTexture::Linear);
+    source->bind();
+
+    // Each halving pass averages 2x2 texels, so that no texel of the source gets skipped
+    QOpenGLFramebufferObject *step = nullptr;
+    QSize stepSize = halved(source->textureSize(), m_size);
+    while (stepSize != source->textureSize() && stepSize != (step ? step->size() : QSize())) {
+        QOpenGLFramebufferObject *target = m_pool->acquire(stepSize);
+        if (!target) {
+            break;
+        }
+        draw(gl, target);
+        if (step) {
+            m_pool->release(step);
+        }
+        step = target;
+
+        gl->glBindTexture(GL_TEXTURE_2D, step->texture());
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        stepSize = halved(stepSize, m_size);
+    }
+
+    draw(gl, m_framebuffer);
+    if (step) {
+        m_pool->release(step);
+    }
+
+    if (m_mipmap) {
+        gl->glBindTexture(GL_TEXTURE_2D, m_framebuffer->texture());
+        gl->glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    gl->glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    gl->glUseProgram(previousProgram);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+    if (blend) gl->glEnable(GL_BLEND);
+    if (depthTest) gl->glEnable(GL_DEPTH_TEST);
+    if (scissorTest) gl->glEnable(GL_SCISSOR_TEST);
+    if (stencilTest) gl->glEnable(GL_STENCIL_TEST);
+
+    m_frameNumber = frameNumber;
+    m_hasAlphaChannel = source->hasAlphaChannel();
+    m_sinceUpdate.start();
+}
+
+// Draws the texture bound to unit 0 over all of the target, with m_program bound
+void SurfaceThumbnail::draw(QOpenGLFunctions *gl, QOpenGLFramebufferObject *target)
+{
+    target->bind();
+    gl->glViewport(0, 0, target->width(), target->height());
+
+    m_program->enableAttributeArray(0);
+    m_program->enableAttributeArray(1);
+    m_program->setAttributeArray(0, GL_FLOAT, quad, 2, 4 * sizeof(GLfloat));
+    m_program->setAttributeArray(1, GL_FLOAT, quad + 2, 2, 4 * sizeof(GLfloat));
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_program->disableAttributeArray(0);
+    m_program->disableAttributeArray(1);
+}
+
+int SurfaceThumbnail::textureId() const
+{
+    return m_framebuffer ? m_framebuffer->texture() : 0;
+}
+
+QSize SurfaceThumbnail::textureSize() const
+{
+    return m_framebuffer ? m_framebuffer->size() : QSize();
+}
+
+bool SurfaceThumbnail::hasMipmaps() const
+{
+    return m_mipmap;
+}
+
+void SurfaceThumbnail::bind()
+{
+    QOpenGLContext::currentContext()->functions()->glBindTexture(GL_TEXTURE_2D, textureId());
+    updateBindOptions(true/* force */);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SURFACETHUMBNAIL_H
+#define SURFACETHUMBNAIL_H
+
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QSGTexture>
+
+class FramebufferPool;
+class QOpenGLFramebufferObject;
+class QOpenGLFunctions;
+class QOpenGLShaderProgram;
+
+// A downscaled copy of a surface texture, for views showing the surface much smaller than its
+// actual size. Sampling it costs a fraction of sampling the full size client buffer, which adds up
+// when a spread shows dozens of windows at once.
+//
+// The source gets halved as many times as it takes to get within twice the thumbnail size before
+// the final pass, as a single bilinear pass from much further away skips most of its texels and
+// aliases. All the framebuffers involved come from the platform's FramebufferPool.
+//
+// The copy only gets redrawn once the surface has a new frame, and no more often than every
+// minimumUpdateInterval milliseconds.
+//
+// Shared by all the views of a surface in the same window, see MirSurfaceInterface::thumbnail().
+// Lives in the rendering (scene graph) thread of that window.
+class SurfaceThumbnail : public QSGTexture
+{
+    Q_OBJECT
+public:
+    SurfaceThumbnail(const QSize &size, bool mipmap);
+    virtual ~SurfaceThumbnail();
+
+    static const int minimumUpdateInterval = 100;
+
+    QSize size() const { return m_size; }
+    bool mipmapRequested() const { return m_requestedMipmap; }
+
+    // Frame of the surface the thumbnail shows, 0 if none yet
+    unsigned int frameNumber() const { return m_frameNumber; }
+
+    // Milliseconds to wait before drawing the given frame into the thumbnail: 0 to draw it right away,
+    // -1 if the thumbnail already shows it
+    int msecsUntilUpdate(unsigned int frameNumber) const;
+
+    // Draws the source texture into the thumbnail. Needs a GL context current.
+    void update(QSGTexture *source, unsigned int frameNumber);
+
+    int textureId() const override;
+    QSize textureSize() const override;
+    bool hasAlphaChannel() const override { return m_hasAlphaChannel; }
+    bool hasMipmaps() const override;
+
+    void bind() override;
+
+private:
+    void draw(QOpenGLFunctions *gl, QOpenGLFramebufferObject *target);
+
+    FramebufferPool *const m_pool;
+    const QSize m_size;
+    QOpenGLFramebufferObject *m_framebuffer; // from m_pool
+    QScopedPointer<QOpenGLShaderProgram> m_program;
+    QElapsedTimer m_sinceUpdate;
+    unsigned int m_frameNumber;
+    const bool m_requestedMipmap;
+    bool m_mipmap; // as far as the GL context supports it
+    bool m_hasAlphaChannel;
+};
+
+#endif // SURFACETHUMBNAIL_H
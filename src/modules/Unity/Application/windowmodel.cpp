@@ -17,6 +17,7 @@
 #include "windowmodel.h"
 
 #include "mirsurface.h"
+#include "tracepoints.h" // generated from tracepoints.tp
 
 // mirserver
 #include "nativeinterface.h"
@@ -24,6 +25,7 @@
 // Qt
 #include <QGuiApplication>
 #include <QDebug>
+#include <QRegion>
 
 using namespace qtmir;
 
@@ -50,6 +52,11 @@ WindowModel::WindowModel(WindowModelNotifier *notifier,
 
 void WindowModel::connectToWindowModelNotifier(WindowModelNotifier *notifier)
 {
+    // Off unless asked for, as only the shell knows where it actually shows the windows
+    if (qgetenv("QTMIR_OCCLUSION_CULLING") == "1") {
+        m_occlusionCulling = true;
+    }
+
     connect(notifier, &WindowModelNotifier::windowAdded,        this, &WindowModel::onWindowAdded,        Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowRemoved,      this, &WindowModel::onWindowRemoved,      Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowReady,        this, &WindowModel::onWindowReady,        Qt::QueuedConnection);
@@ -73,11 +80,18 @@ void WindowModel::onWindowAdded(const NewWindow &window)
         return;
     }
 
+    auto mirSurface = new MirSurface(window, m_windowController);
+    connect(mirSurface, &MirSurface::positionChanged, this, &WindowModel::scheduleOcclusionUpdate);
+    connect(mirSurface, &MirSurface::sizeChanged, this, &WindowModel::scheduleOcclusionUpdate);
+    connect(mirSurface, &MirSurface::visibleChanged, this, &WindowModel::scheduleOcclusionUpdate);
+    connect(mirSurface, &MirSurface::ready, this, &WindowModel::scheduleOcclusionUpdate);
+
     const int index = m_windowModel.count();
     beginInsertRows(QModelIndex(), index, index);
-    m_windowModel.append(new MirSurface(window, m_windowController));
+    m_windowModel.append(mirSurface);
     endInsertRows();
     Q_EMIT countChanged();
+    scheduleOcclusionUpdate();
 }
 
 void WindowModel::onWindowRemoved(const miral::WindowInfo &windowInfo)
@@ -90,9 +104,11 @@ void WindowModel::onWindowRemoved(const miral::WindowInfo &windowInfo)
     const int index = findIndexOf(windowInfo.window());
 
     beginRemoveRows(QModelIndex(), index, index);
-    m_windowModel.takeAt(index);
+    auto mirSurface = m_windowModel.takeAt(index);
     endRemoveRows();
+    disconnect(mirSurface, nullptr, this, nullptr);
     Q_EMIT countChanged();
+    scheduleOcclusionUpdate();
 }
 
 void WindowModel::onWindowReady(const miral::WindowInfo &windowInfo)
@@ -193,6 +209,56 @@ void WindowModel::onWindowsRaised(const std::vector<miral::Window> &windows)
 
         endMoveRows();
     }
+
+    scheduleOcclusionUpdate();
+}
+
+void WindowModel::setOcclusionCulling(bool enabled)
+{
+    if (m_occlusionCulling == enabled) {
+        return;
+    }
+
+    m_occlusionCulling = enabled;
+    updateOcclusion();
+    Q_EMIT occlusionCullingChanged(enabled);
+}
+
+// Coalesces the geometry and stacking changes of a batch of Mir events into a single occlusion pass
+void WindowModel::scheduleOcclusionUpdate()
+{
+    if (!m_occlusionUpdatePending) {
+        m_occlusionUpdatePending = true;
+        QMetaObject::invokeMethod(this, "updateOcclusion", Qt::QueuedConnection);
+    }
+}
+
+void WindowModel::updateOcclusion()
+{
+    m_occlusionUpdatePending = false;
+
+    // Walk the windows from the top of the stack down, collecting what opaque windows cover
+    QRegion covered;
+    int occludedCount = 0;
+    for (int i = m_windowModel.count() - 1; i >= 0; i--) {
+        MirSurface *mirSurface = m_windowModel[i];
+        if (!mirSurface->visible()) {
+            mirSurface->setOccluded(false); // hidden anyway
+            continue;
+        }
+
+        const QRect rect(mirSurface->position(), mirSurface->size());
+        const bool occluded = m_occlusionCulling && !rect.isEmpty() && (QRegion(rect) - covered).isEmpty();
+        mirSurface->setOccluded(occluded);
+
+        if (occluded) {
+            occludedCount++;
+        } else if (m_occlusionCulling && mirSurface->isOpaque()) {
+            covered += rect;
+        }
+    }
+
+    tracepoint(qtmir, occlusionUpdated, m_windowModel.count(), occludedCount);
 }
 
 int WindowModel::rowCount(const QModelIndex &/*parent*/) const
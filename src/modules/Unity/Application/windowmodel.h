@@ -34,6 +34,11 @@ class WindowModel : public QAbstractListModel
 
     Q_PROPERTY(MirSurfaceInterface* inputMethodSurface READ inputMethodSurface NOTIFY inputMethodSurfaceChanged)
 
+    // Whether windows fully covered by opaque windows stacked on top, according to their position and size,
+    // are told they're occluded. Off by default, or if QTMIR_OCCLUSION_CULLING is not set to 1, as the shell
+    // may show windows elsewhere, like in a spread. Should only be enabled while it shows them where Mir has them.
+    Q_PROPERTY(bool occlusionCulling READ occlusionCulling WRITE setOcclusionCulling NOTIFY occlusionCullingChanged)
+
 public:
     enum Roles {
         SurfaceRole = Qt::UserRole
@@ -53,9 +58,13 @@ public:
 
     MirSurface* inputMethodSurface() const { return m_inputMethodSurface; }
 
+    bool occlusionCulling() const { return m_occlusionCulling; }
+    void setOcclusionCulling(bool enabled);
+
 Q_SIGNALS:
     void countChanged();
     void inputMethodSurfaceChanged(MirSurfaceInterface* inputMethodSurface);
+    void occlusionCullingChanged(bool enabled);
 
 private Q_SLOTS:
     void onWindowAdded(const qtmir::NewWindow &windowInfo);
@@ -65,6 +74,7 @@ private Q_SLOTS:
     void onWindowStateChanged(const miral::WindowInfo &windowInfo, Mir::State state);
     void onWindowFocusChanged(const miral::WindowInfo &windowInfo, bool focused);
     void onWindowsRaised(const std::vector<miral::Window> &windows);
+    void updateOcclusion();
 
 private:
     void connectToWindowModelNotifier(WindowModelNotifier *notifier);
@@ -73,10 +83,13 @@ private:
     void removeInputMethodWindow();
     MirSurface* find(const miral::WindowInfo &needle) const;
     int findIndexOf(const miral::Window &needle) const;
+    void scheduleOcclusionUpdate();
 
     QVector<MirSurface*> m_windowModel;
     WindowControllerInterface *m_windowController;
     MirSurface* m_inputMethodSurface{nullptr};
+    bool m_occlusionCulling{false};
+    bool m_occlusionUpdatePending{false};
 };
 
 } // namespace qtmir
@@ -17,17 +17,50 @@
 #include "qquickscreenwindow.h"
 
 // mirserver
+#include "framecaptureinterface.h"
 #include "screen.h"
 #include "screenscontroller.h"
 
 // Qt
 #include <QGuiApplication>
+#include <QPointer>
+#include <QRunnable>
 #include <QScreen>
+#include <QThreadPool>
 #include <qpa/qplatformnativeinterface.h>
 #include <QDebug>
 
 using namespace qtmir;
 
+namespace {
+
+// Encoding takes far too long for the render thread, which hands over the frame
+class SaveFrameJob : public QRunnable
+{
+public:
+    SaveFrameJob(const std::shared_ptr<const CapturedFrame> &frame, const QString &fileName,
+                 const QPointer<QQuickScreenWindow> &window)
+        : m_frame(frame), m_fileName(fileName), m_window(window) {}
+
+    void run() override
+    {
+        const bool success = m_frame && frameImage(*m_frame).save(m_fileName);
+        m_frame.reset(); // back to the ring
+
+        if (m_window) {
+            QMetaObject::invokeMethod(m_window.data(), "grabbedToFile", Qt::QueuedConnection,
+                                      Q_ARG(QString, m_fileName), Q_ARG(bool, success));
+        }
+    }
+
+private:
+    std::shared_ptr<const CapturedFrame> m_frame;
+    const QString m_fileName;
+    const QPointer<QQuickScreenWindow> m_window;
+};
+
+} // namespace {
+
 /*
  * QQuickScreenWindow - wrapper of QQuickWindow to enable QML to specify destination screen
  * and read Mir-specific properties of that screen like scale & form factor
@@ -125,6 +158,25 @@ bool QQuickScreenWindow::setScaleAndFormFactor(const float scale, const FormFact
     return controller->setConfiguration(configs);
 }
 
+bool QQuickScreenWindow::grabToFile(const QString &fileName)
+{
+    if (!handle()) {
+        return false;
+    }
+
+    auto frameCapture = static_cast<FrameCaptureInterface*>(qGuiApp->platformNativeInterface()
+                                                            ->nativeResourceForWindow("FrameCapture", this));
+    if (!frameCapture) {
+        return false;
+    }
+
+    const QPointer<QQuickScreenWindow> window(this);
+    frameCapture->captureNextFrame([fileName, window](const std::shared_ptr<const CapturedFrame> &frame) {
+        QThreadPool::globalInstance()->start(new SaveFrameJob(frame, fileName, window));
+    });
+    return true;
+}
+
 FormFactor QQuickScreenWindow::formFactor()
 {
     if (m_formFactor == FormFactorUnknown) {
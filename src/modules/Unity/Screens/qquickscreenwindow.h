@@ -40,10 +40,15 @@ public:
     FormFactor formFactor();
     Q_INVOKABLE bool setScaleAndFormFactor(const float scale, const FormFactor formFactor);
 
+    // Saves the next frame shown on the screen to an image file, without stalling rendering.
+    // Returns false if frames of the screen can't be captured. Else grabbedToFile() follows.
+    Q_INVOKABLE bool grabToFile(const QString &fileName);
+
 Q_SIGNALS:
     void screenChanged(QScreen *screen);
     void scaleChanged(qreal scale);
     void formFactorChanged(FormFactor arg);
+    void grabbedToFile(const QString &fileName, bool success);
 
 private Q_SLOTS:
     void nativePropertyChanged(QPlatformWindow *window, const QString &propertyName);
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capturering.h"
+#include "logging.h"
+
+// Qt
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+// std
+#include <atomic>
+
+// local system
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace qtmir;
+
+namespace {
+
+int createMemoryFile()
+{
+#ifdef SYS_memfd_create
+    int fd = syscall(SYS_memfd_create, "qtmir-capture", 1 /* MFD_CLOEXEC */);
+    if (fd >= 0) {
+        return fd;
+    }
+#endif
+
+    // Kernels without memfd: a POSIX shared memory object, unlinked right away
+    static std::atomic<int> counter{0};
+    const QByteArray name = QByteArray("/qtmir-capture-") + QByteArray::number(getpid())
+        + '-' + QByteArray::number(counter++);
+    int fd = shm_open(name.constData(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd >= 0) {
+        shm_unlink(name.constData());
+    }
+    return fd;
+}
+
+} // namespace {
+
+struct CaptureRing::Slot
+{
+    int fd{-1};
+    uchar *memory{nullptr};
+    size_t capacity{0};
+    bool claimed{false};
+    bool published{false};
+};
+
+struct CaptureRing::State
+{
+    ~State()
+    {
+        Q_FOREACH (const Slot &slot, slots) {
+            if (slot.memory) {
+                munmap(slot.memory, slot.capacity);
+            }
+            if (slot.fd >= 0) {
+                close(slot.fd);
+            }
+        }
+    }
+
+    bool grow(Slot &slot, size_t byteCount)
+    {
+        if (slot.fd < 0) {
+            slot.fd = createMemoryFile();
+            if (slot.fd < 0) {
+                return false;
+            }
+        }
+
+        if (slot.memory) {
+            munmap(slot.memory, slot.capacity);
+            slot.memory = nullptr;
+            slot.capacity = 0;
+        }
+
+        if (ftruncate(slot.fd, byteCount) != 0) {
+            return false;
+        }
+
+        void *memory = mmap(nullptr, byteCount, PROT_READ | PROT_WRITE, MAP_SHARED, slot.fd, 0);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+
+        slot.memory = static_cast<uchar*>(memory);
+        slot.capacity = byteCount;
+        return true;
+    }
+
+    QMutex mutex;
+    QVector<Slot> slots;
+    int nextSlot{0}; // claims go round the ring, so the oldest frames get overwritten first
+    quint64 sequence{0};
+    quint64 skippedCount{0};
+};
+
+CaptureRing::CaptureRing(int slotCount)
+    : d(std::make_shared<State>())
+{
+    d->slots.resize(qMax(slotCount, 1));
+}
+
+CaptureRing::~CaptureRing()
+{
+    qCDebug(QTMIR_SCREENS) << "CaptureRing: frames=" << d->sequence << "skipped=" << d->skippedCount;
+}
+
+uchar *CaptureRing::claim(size_t byteCount, int *slot)
+{
+    QMutexLocker locker(&d->mutex);
+
+    for (int i = 0; i < d->slots.count(); ++i) {
+        const int index = (d->nextSlot + i) % d->slots.count();
+        Slot &candidate = d->slots[index];
+        if (candidate.claimed || candidate.published) {
+            continue;
+        }
+
+        if (candidate.capacity < byteCount && !d->grow(candidate, byteCount)) {
+            qCWarning(QTMIR_SCREENS) << "CaptureRing: failed to allocate" << byteCount << "bytes";
+            break;
+        }
+
+        candidate.claimed = true;
+        d->nextSlot = (index + 1) % d->slots.count();
+        *slot = index;
+        return candidate.memory;
+    }
+
+    ++d->skippedCount;
+    return nullptr;
+}
+
+std::shared_ptr<const CapturedFrame> CaptureRing::publish(int slot, const CapturedFrame &frame)
+{
+    QMutexLocker locker(&d->mutex);
+
+    Slot &claimed = d->slots[slot];
+    Q_ASSERT(claimed.claimed);
+    claimed.claimed = false;
+    claimed.published = true;
+
+    auto published = new CapturedFrame(frame);
+    published->fd = claimed.fd;
+    published->pixels = claimed.memory;
+    published->sequence = d->sequence++;
+
+    // The state goes along with the frame, so the memory outlives the ring if need be
+    const std::shared_ptr<State> state = d;
+    return std::shared_ptr<const CapturedFrame>(published, [state, slot](const CapturedFrame *frame) {
+        QMutexLocker locker(&state->mutex);
+        state->slots[slot].published = false;
+        delete frame;
+    });
+}
+
+void CaptureRing::unclaim(int slot)
+{
+    QMutexLocker locker(&d->mutex);
+    d->slots[slot].claimed = false;
+}
+
+int CaptureRing::slotCount() const
+{
+    return d->slots.count();
+}
+
+quint64 CaptureRing::skippedCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->skippedCount;
+}
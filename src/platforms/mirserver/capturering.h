@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURERING_H
+#define CAPTURERING_H
+
+#include "framecaptureinterface.h"
+
+#include <memory>
+
+/*
+ * CaptureRing holds captured frames in a fixed number of shared memory slots.
+ *
+ * A frame is written to a slot claimed from the ring, then published. Its slot is only claimed
+ * again once the last reference to the published frame is gone, so consumers can read the pixels,
+ * or pass the fd on to another process, for as long as they keep the frame. When consumers hold on
+ * to every slot, claims fail and the producer is expected to skip the frame instead of waiting.
+ *
+ * Slots are anonymous memory files, grown as needed and only shrunk when the ring goes away.
+ * Published frames keep the memory alive even past the destruction of the ring.
+ *
+ * Threading Note:
+ * All methods are thread-safe. Frames can be released from any thread.
+ */
+class CaptureRing
+{
+public:
+    static const int defaultSlotCount = 3;
+
+    explicit CaptureRing(int slotCount = defaultSlotCount);
+    ~CaptureRing();
+
+    // Claims a slot no frame is using, big enough for byteCount bytes. Returns where to write the
+    // frame, or nullptr if no slot is free or the memory couldn't be had.
+    uchar *claim(size_t byteCount, int *slot);
+
+    // Hands out the frame written to a claimed slot. fd, pixels and sequence get filled in here.
+    std::shared_ptr<const qtmir::CapturedFrame> publish(int slot, const qtmir::CapturedFrame &frame);
+
+    // Gives back a claimed slot without publishing anything
+    void unclaim(int slot);
+
+    int slotCount() const;
+
+    // Number of claims that failed
+    quint64 skippedCount() const;
+
+private:
+    struct Slot;
+    struct State;
+
+    const std::shared_ptr<State> d;
+};
+
+#endif // CAPTURERING_H
@@ -16,6 +16,8 @@
  */
 
 #include "cursor.h"
+#include "cursorcache.h"
+#include "hardwarecursor.h"
 #include "logging.h"
 
 #include "mirsingleton.h"
@@ -62,19 +64,23 @@ void Cursor::changeCursor(QCursor *windowCursor, QWindow * /*window*/)
     if (windowCursor) {
         if (windowCursor->pixmap().isNull()) {
             m_qtCursorName = m_shapeToCursorName.value(windowCursor->shape(), QStringLiteral("left_ptr"));
-            m_mousePointer->setCustomCursor(QCursor());
+            m_customCursor = QCursor();
+            m_customCursorImage = QImage();
         } else {
-            // Ensure we get different names for consecutive custom cursors.
-            // The name doesn't have to be unique (ie, different from all custom cursor names generated so far),
-            // just different from the previous custom cursor name, which is enough to trigger a change in the cursor
-            // source image URL in the QML side which on is turn makes QML request the new cursor image.
-            static quint8 serialNumber = 1;
-            m_qtCursorName = QString("custom%1").arg(serialNumber++);
-            m_mousePointer->setCustomCursor(*windowCursor);
+            // Different custom cursors get different names, which is what makes QML request the new cursor
+            // image. The same cursor set again keeps its name, sparing QML the reload.
+            const QString cursorName = CursorCache::instance()->nameOf(*windowCursor);
+            if (cursorName != m_qtCursorName || m_customCursorImage.isNull()) {
+                // Converted once per cursor, rather than on every update of the hardware cursor
+                m_customCursorImage = windowCursor->pixmap().toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            }
+            m_qtCursorName = cursorName;
+            m_customCursor = *windowCursor;
         }
     } else {
         m_qtCursorName.clear();
-        m_mousePointer->setCustomCursor(QCursor());
+        m_customCursor = QCursor();
+        m_customCursorImage = QImage();
     }
 
     updateMousePointerCursorName();
@@ -88,13 +94,24 @@ void Cursor::setMirCursorName(const QString &mirCursorName)
 
 void Cursor::setMousePointer(MirMousePointerInterface *mousePointer)
 {
-    QMutexLocker locker(&m_mutex);
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (mousePointer && !m_mousePointer.isNull()) {
+            qFatal("QPA mirserver: Only one MousePointer per screen is allowed!");
+        }
 
-    if (mousePointer && !m_mousePointer.isNull()) {
-        qFatal("QPA mirserver: Only one MousePointer per screen is allowed!");
+        if (m_mousePointer) {
+            disconnect(m_mousePointer, nullptr, this, nullptr);
+        }
+        m_mousePointer = mousePointer;
+    }
+
+    if (mousePointer && HardwareCursor::instance()) {
+        // The hardware cursor is hidden along with it
+        connect(mousePointer, &QQuickItem::visibleChanged, this, &Cursor::updateMousePointerCursorName);
     }
 
-    m_mousePointer = mousePointer;
     updateMousePointerCursorName();
 }
 
@@ -103,7 +120,7 @@ bool Cursor::handleMouseEvent(ulong timestamp, QPointF movement, Qt::MouseButton
 {
     QMutexLocker locker(&m_mutex);
 
-    if (!m_mousePointer || !m_mousePointer->isVisible()) {
+    if (!m_mousePointer || !m_mousePointer->isVisible() || m_hardwareCursorShown) {
         return false;
     }
 
@@ -125,7 +142,7 @@ bool Cursor::handleWheelEvent(ulong timestamp, QPoint angleDelta, Qt::KeyboardMo
 {
     QMutexLocker locker(&m_mutex);
 
-    if (!m_mousePointer || !m_mousePointer->isVisible()) {
+    if (!m_mousePointer || !m_mousePointer->isVisible() || m_hardwareCursorShown) {
         return false;
     }
 
@@ -160,7 +177,10 @@ void Cursor::setPos(const QPoint &pos)
 
 QPoint Cursor::pos() const
 {
-    if (m_mousePointer) {
+    auto hardwareCursor = HardwareCursor::instance();
+    if (hardwareCursor && m_hardwareCursorShown) {
+        return hardwareCursor->position();
+    } else if (m_mousePointer) {
         return m_mousePointer->mapToItem(nullptr, QPointF(0, 0)).toPoint();
     } else {
         return QPlatformCursor::pos();
@@ -169,17 +189,65 @@ QPoint Cursor::pos() const
 
 void Cursor::updateMousePointerCursorName()
 {
+    QString cursorName;
+    if (m_mirCursorName.isEmpty()) {
+        if (m_qtCursorName.isEmpty()) {
+            cursorName = QStringLiteral("left_ptr");
+        } else {
+            cursorName = m_qtCursorName;
+        }
+    } else {
+        cursorName = m_mirCursorName;
+    }
+
+    if (updateHardwareCursor(cursorName)) {
+        // Nothing left for QML to draw
+        m_mousePointer->setCustomCursor(QCursor());
+        m_mousePointer->setCursorName(QStringLiteral("blank"));
+        return;
+    }
+
     if (!m_mousePointer) {
         return;
     }
 
-    if (m_mirCursorName.isEmpty()) {
-        if (m_qtCursorName.isEmpty()) {
-            m_mousePointer->setCursorName(QStringLiteral("left_ptr"));
+    m_mousePointer->setCustomCursor(m_customCursor);
+    m_mousePointer->setCursorName(cursorName);
+}
+
+// Returns whether the pointer is now shown on the hardware cursor plane. It's left to QML for
+// names the server side cursor theme lacks.
+bool Cursor::updateHardwareCursor(const QString &cursorName)
+{
+    auto hardwareCursor = HardwareCursor::instance();
+    if (!hardwareCursor) {
+        return false;
+    }
+
+    bool shown = false;
+    if (m_mousePointer && m_mousePointer->isVisible()) {
+        // As with QML, the cursor Mir asks for wins over the one set on the window
+        if (m_mirCursorName.isEmpty() && !m_customCursorImage.isNull()) {
+            hardwareCursor->showImage(m_customCursorImage, m_customCursor.hotSpot());
+            shown = true;
         } else {
-            m_mousePointer->setCursorName(m_qtCursorName);
+            shown = hardwareCursor->showNamed(cursorName.toLatin1());
         }
-    } else {
-        m_mousePointer->setCursorName(m_mirCursorName);
+    } else if (m_hardwareCursorShown) {
+        hardwareCursor->conceal();
+    }
+
+    bool handedToQml;
+    {
+        QMutexLocker locker(&m_mutex);
+        handedToQml = m_hardwareCursorShown && !shown;
+        m_hardwareCursorShown = shown;
+    }
+
+    if (handedToQml && m_mousePointer) {
+        // QML carries on from where Mir moved the pointer meanwhile
+        setPos(hardwareCursor->position());
     }
+
+    return shown;
 }
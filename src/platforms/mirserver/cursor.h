@@ -18,6 +18,8 @@
 #ifndef QTMIR_CURSOR_H
 #define QTMIR_CURSOR_H
 
+#include <QCursor>
+#include <QImage>
 #include <QMutex>
 #include <QPointer>
 
@@ -56,11 +58,17 @@ private Q_SLOTS:
 
 private:
     void updateMousePointerCursorName();
+    bool updateHardwareCursor(const QString &cursorName);
     QMutex m_mutex;
     QPointer<MirMousePointerInterface> m_mousePointer;
     QMap<int,QString> m_shapeToCursorName;
     QString m_qtCursorName;
     QString m_mirCursorName;
+    QCursor m_customCursor;
+    QImage m_customCursorImage; // m_customCursor as the hardware cursor plane takes it
+
+    // Whether the pointer is drawn on the hardware cursor plane instead of by m_mousePointer
+    bool m_hardwareCursorShown{false}; // guarded by m_mutex
 };
 
 } // namespace qtmir
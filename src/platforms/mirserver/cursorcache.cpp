@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cursorcache.h"
+
+// Qt
+#include <QHash>
+#include <QImage>
+#include <QMutexLocker>
+#include <QPixmap>
+
+#include <cstring>
+
+using namespace qtmir;
+
+const int CursorCache::defaultCapacity;
+
+CursorCache *CursorCache::instance()
+{
+    static CursorCache cache;
+    return &cache;
+}
+
+CursorCache::CursorCache(int capacity)
+    : m_capacity(capacity)
+{
+}
+
+QCursor CursorCache::cursor(const void *argbPixels, const QSize &size, const QPoint &hotspot)
+{
+    QMutexLocker locker(&m_mutex);
+    return find(argbPixels, size, hotspot, nullptr).cursor;
+}
+
+QString CursorCache::nameOf(const QCursor &cursor)
+{
+    const qint64 pixmapKey = cursor.pixmap().cacheKey();
+
+    QMutexLocker locker(&m_mutex);
+
+    // Most likely one handed out by cursor() above
+    for (int i = 0; i < m_entries.count(); ++i) {
+        if (m_entries[i].pixmapKey == pixmapKey) {
+            ++m_hitCount;
+            m_entries.move(i, 0);
+            return m_entries.first().name;
+        }
+    }
+
+    locker.unlock();
+    const QImage image = cursor.pixmap().toImage().convertToFormat(QImage::Format_ARGB32);
+    locker.relock();
+
+    return find(image.constBits(), image.size(), cursor.hotSpot(), &cursor).name;
+}
+
+int CursorCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+quint64 CursorCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+quint64 CursorCache::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_missCount;
+}
+
+const CursorCache::Entry &CursorCache::find(const void *argbPixels, const QSize &size, const QPoint &hotspot,
+                                            const QCursor *cursor)
+{
+    const int byteCount = size.width() * size.height() * 4;
+    const uint hash = qHash(hotspot.x(), qHash(hotspot.y(), qHashBits(argbPixels, byteCount, size.width())));
+
+    for (int i = 0; i < m_entries.count(); ++i) {
+        const Entry &entry = m_entries[i];
+        if (entry.hash == hash && entry.size == size && entry.hotspot == hotspot
+                && memcmp(entry.pixels.constData(), argbPixels, byteCount) == 0) {
+            ++m_hitCount;
+            m_entries.move(i, 0);
+            return m_entries.first();
+        }
+    }
+
+    ++m_missCount;
+
+    Entry entry;
+    entry.hash = hash;
+    entry.size = size;
+    entry.hotspot = hotspot;
+    entry.pixels = QByteArray(static_cast<const char*>(argbPixels), byteCount);
+    if (cursor) {
+        entry.cursor = *cursor;
+    } else {
+        QImage image(reinterpret_cast<const uchar*>(entry.pixels.constData()), size.width(), size.height(),
+                     QImage::Format_ARGB32);
+        entry.cursor = QCursor(QPixmap::fromImage(image), hotspot.x(), hotspot.y());
+    }
+    entry.pixmapKey = entry.cursor.pixmap().cacheKey();
+    // Names are never reused, so that QML can't mistake a cursor for an evicted one
+    entry.name = QStringLiteral("custom%1").arg(m_nextSerialNumber++);
+
+    if (m_entries.count() >= m_capacity) {
+        m_entries.removeLast();
+    }
+    m_entries.prepend(entry);
+    return m_entries.first();
+}
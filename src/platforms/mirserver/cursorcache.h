@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_CURSORCACHE_H
+#define QTMIR_CURSORCACHE_H
+
+// Qt
+#include <QByteArray>
+#include <QCursor>
+#include <QList>
+#include <QMutex>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+
+namespace qtmir {
+
+/*
+    Keeps the pixmap cursors lately set, so that setting one again gets back the very same QCursor,
+    pixmap included, and the same name, instead of a new conversion and a QML image reload.
+
+    Cursors are told apart by a hash of their pixels, size and hotspot, the least recently used
+    one making room for new ones.
+
+    Threading Note:
+    Thread-safe. Mir hands out cursor images in its own threads, qtmir::Cursor asks for names in
+    Qt's GUI thread.
+ */
+class CursorCache
+{
+public:
+    static const int defaultCapacity = 32;
+
+    static CursorCache *instance();
+
+    explicit CursorCache(int capacity = defaultCapacity);
+
+    // A cursor for the given ARGB32 pixels, tightly packed
+    QCursor cursor(const void *argbPixels, const QSize &size, const QPoint &hotspot);
+
+    // A name for the given pixmap cursor, the same for cursors looking the same
+    QString nameOf(const QCursor &cursor);
+
+    int count() const;
+    quint64 hitCount() const;
+    quint64 missCount() const;
+
+private:
+    struct Entry {
+        uint hash;
+        QSize size;
+        QPoint hotspot;
+        QByteArray pixels;
+        QCursor cursor;
+        qint64 pixmapKey;
+        QString name;
+    };
+
+    // Moves the entry found to the front, adding one if needed
+    const Entry &find(const void *argbPixels, const QSize &size, const QPoint &hotspot, const QCursor *cursor);
+
+    const int m_capacity;
+    mutable QMutex m_mutex;
+    QList<Entry> m_entries; // most recently used first. Few enough for a linear search to do.
+    quint64 m_nextSerialNumber{1};
+    quint64 m_hitCount{0};
+    quint64 m_missCount{0};
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_CURSORCACHE_H
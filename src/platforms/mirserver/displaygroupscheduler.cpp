@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "displaygroupscheduler.h"
+#include "logging.h"
+#include "screen.h"
+#include "tracepoints.h" // generated from tracepoints.tp
+
+// Mir
+#include <mir/graphics/display.h>
+
+// Qt
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+// std
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+const qreal defaultRefreshRate = 60.0;
+}
+
+DisplayGroupScheduler::DisplayGroupScheduler(mir::graphics::DisplaySyncGroup *group)
+    : m_group(group)
+    , m_frame(0)
+    , m_posting(false)
+{
+}
+
+void DisplayGroupScheduler::addScreen(Screen *screen, bool rendering)
+{
+    QMutexLocker locker(&m_mutex);
+    m_screens.insert(screen);
+    if (rendering) {
+        m_renderingScreens.insert(screen);
+    }
+}
+
+void DisplayGroupScheduler::removeScreen(Screen *screen)
+{
+    QMutexLocker locker(&m_mutex);
+    m_screens.remove(screen);
+    m_renderingScreens.remove(screen);
+    m_startedScreens.remove(screen);
+    m_swappedScreens.remove(screen);
+
+    // the Screens left might be waiting on this one
+    m_framePosted.wakeAll();
+}
+
+void DisplayGroupScheduler::setScreenRendering(Screen *screen, bool rendering)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_screens.contains(screen)) {
+        return;
+    }
+
+    qCDebug(QTMIR_SCREENS) << "DisplayGroupScheduler::setScreenRendering" << screen << rendering;
+
+    if (rendering) {
+        m_renderingScreens.insert(screen);
+    } else {
+        m_renderingScreens.remove(screen);
+        m_startedScreens.remove(screen);
+        m_framePosted.wakeAll(); // the Screens left might be waiting on this one
+    }
+}
+
+void DisplayGroupScheduler::frameStarted(Screen *screen)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_renderingScreens.contains(screen)) {
+        m_startedScreens.insert(screen);
+    }
+}
+
+void DisplayGroupScheduler::frameDropped(Screen *screen)
+{
+    QMutexLocker locker(&m_mutex);
+    m_startedScreens.remove(screen);
+    m_framePosted.wakeAll(); // the Screens left might be waiting on this one
+}
+
+void DisplayGroupScheduler::frameSwapped(Screen *screen)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // A post is in flight already, so this frame will go with the next one
+    while (m_posting) {
+        m_framePosted.wait(&m_mutex);
+    }
+
+    const quint64 frame = m_frame;
+    m_swappedScreens.insert(screen);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const int timeout = frameTimeout();
+
+    while (m_frame == frame) {
+        if (m_posting) {
+            // someone else is posting our frame
+            m_framePosted.wait(&m_mutex);
+            continue;
+        }
+
+        if (allStartedFramesSwapped()) {
+            post(locker);
+            return;
+        }
+
+        const qint64 remaining = timeout - elapsed.elapsed();
+        if (remaining <= 0) {
+            qCDebug(QTMIR_SCREENS) << "DisplayGroupScheduler - not all screens rendered a frame in time, posting"
+                                   << m_swappedScreens.count() << "of" << (m_startedScreens + m_swappedScreens).count();
+            post(locker);
+            return;
+        }
+
+        m_framePosted.wait(&m_mutex, remaining);
+    }
+}
+
+quint64 DisplayGroupScheduler::postCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frame;
+}
+
+bool DisplayGroupScheduler::allStartedFramesSwapped() const
+{
+    Q_FOREACH (Screen *screen, m_startedScreens) {
+        if (!m_swappedScreens.contains(screen)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int DisplayGroupScheduler::frameTimeout() const
+{
+    // Give the other Screens up to one refresh interval of the slowest output to finish their frame
+    qreal refreshRate = 0;
+    Q_FOREACH (Screen *screen, m_screens) {
+        if (screen->refreshRate() > 0 && (refreshRate <= 0 || screen->refreshRate() < refreshRate)) {
+            refreshRate = screen->refreshRate();
+        }
+    }
+    if (refreshRate <= 0) {
+        refreshRate = defaultRefreshRate;
+    }
+    return static_cast<int>(std::ceil(1000.0 / refreshRate));
+}
+
+// Called with m_mutex locked. Unlocks it while posting, as post() blocks until the next vsync,
+// and while sleeping after it
+void DisplayGroupScheduler::post(QMutexLocker &locker)
+{
+    m_posting = true;
+    const int screenCount = m_swappedScreens.count();
+    m_startedScreens.subtract(m_swappedScreens);
+    m_swappedScreens.clear();
+
+    locker.unlock();
+    m_group->post();
+    tracepoint(qtmirserver, displayGroupPosted, screenCount);
+
+    // Outputs not throttled by vsync return from post() right away. Like Mir's own compositor,
+    // hold the render threads for as long as the platform recommends, so that they don't render,
+    // nor release client buffers, faster than the screens refresh.
+    const std::chrono::milliseconds sleep = m_group->recommended_sleep();
+    if (sleep > std::chrono::milliseconds::zero()) {
+        std::this_thread::sleep_for(sleep);
+    }
+    locker.relock();
+
+    ++m_frame;
+    m_posting = false;
+    m_framePosted.wakeAll();
+}
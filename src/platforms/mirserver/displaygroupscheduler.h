@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DISPLAYGROUPSCHEDULER_H
+#define DISPLAYGROUPSCHEDULER_H
+
+// Qt
+#include <QMutex>
+#include <QSet>
+#include <QWaitCondition>
+
+class QMutexLocker;
+class Screen;
+namespace mir { namespace graphics { class DisplaySyncGroup; }}
+
+/*
+ * DisplayGroupScheduler posts a Mir DisplaySyncGroup once per frame, on behalf of all its Screens.
+ *
+ * A DisplaySyncGroup can hold several DisplayBuffers, and one post() call submits all of them for
+ * flipping. Each of those DisplayBuffers backs a Screen, which Qt renders from its own render thread.
+ * So instead of every render thread posting the whole group (and blocking the other Screens' swaps
+ * until the next vsync), each one reports its swapped frame here and the last Screen of the group to
+ * finish its frame posts for all of them. The other render threads wait for that post, so all Screens
+ * of the group start rendering their next frame at the same vsync.
+ *
+ * Qt only renders a window when its scene changed, so a Screen may well skip a frame. Only Screens
+ * that started rendering a frame get waited for, so an idle Screen never holds back an animating one.
+ * The wait is still bounded to one refresh interval, after which the group gets posted regardless.
+ *
+ * Threading Note:
+ * addScreen(), removeScreen() and setScreenRendering() are called from the Qt GUI thread, while
+ * frameStarted() and frameSwapped() are called from the Qt render threads.
+ */
+class DisplayGroupScheduler
+{
+public:
+    explicit DisplayGroupScheduler(mir::graphics::DisplaySyncGroup *group);
+
+    mir::graphics::DisplaySyncGroup *group() const { return m_group; }
+
+    void addScreen(Screen *screen, bool rendering);
+    void removeScreen(Screen *screen);
+    void setScreenRendering(Screen *screen, bool rendering);
+
+    // The Screen started rendering a frame, which the others of the group should wait for
+    void frameStarted(Screen *screen);
+
+    // The Screen dropped the frame it started, which the others of the group shouldn't wait for
+    void frameDropped(Screen *screen);
+
+    // Blocks until the frame of the given Screen got posted, and the sleep the platform
+    // recommends after posting passed
+    void frameSwapped(Screen *screen);
+
+    quint64 postCount() const;
+
+private:
+    bool allStartedFramesSwapped() const;
+    int frameTimeout() const;
+    void post(QMutexLocker &locker);
+
+    mir::graphics::DisplaySyncGroup *const m_group;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_framePosted;
+    QSet<Screen*> m_screens;
+    QSet<Screen*> m_renderingScreens;
+    QSet<Screen*> m_startedScreens; // rendering a frame not posted yet
+    QSet<Screen*> m_swappedScreens;
+    quint64 m_frame;
+    bool m_posting;
+};
+
+#endif // DISPLAYGROUPSCHEDULER_H
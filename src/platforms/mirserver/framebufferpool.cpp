@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framebufferpool.h"
+#include "logging.h"
+#include "tracepoints.h" // generated from tracepoints.tp
+
+// Qt
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+
+namespace {
+
+const qint64 defaultPoolMegabytes = 64;
+
+qint64 estimateBytes(const QSize &size, const QOpenGLFramebufferObjectFormat &format)
+{
+    qint64 bytesPerPixel = 4; // color attachment
+    if (format.attachment() != QOpenGLFramebufferObject::NoAttachment) {
+        bytesPerPixel += 4; // packed depth & stencil, or a depth buffer of 24 bits
+    }
+    return qint64(size.width()) * size.height() * bytesPerPixel * qMax(format.samples(), 1);
+}
+
+} // namespace {
+
+FramebufferPool::FramebufferPool(qint64 maxBytes)
+    : m_maxBytes(maxBytes)
+    , m_totalBytes(0)
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+}
+
+FramebufferPool::~FramebufferPool()
+{
+    qCDebug(QTMIR_SCREENS) << "FramebufferPool: hits=" << m_hitCount << "misses=" << m_missCount;
+
+    Q_FOREACH (const QMetaObject::Connection &connection, m_contextConnections) {
+        QObject::disconnect(connection);
+    }
+
+    // Any GL context left takes the GL objects down with it
+    clear();
+}
+
+qint64 FramebufferPool::defaultMaxBytes()
+{
+    bool ok;
+    const qint64 megabytes = qgetenv("QTMIR_OFFSCREEN_BUFFER_POOL_MB").toLongLong(&ok);
+    return (ok && megabytes >= 0 ? megabytes : defaultPoolMegabytes) * 1024 * 1024;
+}
+
+QOpenGLFramebufferObject *FramebufferPool::acquire(const QSize &size, const QOpenGLFramebufferObjectFormat &format)
+{
+    QOpenGLContext *context = currentContext();
+    if (!context) {
+        qCWarning(QTMIR_SCREENS) << "FramebufferPool::acquire - no current GL context";
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    watchContext(context);
+
+    // Framebuffer objects can't be shared between GL contexts
+    for (int i = m_idleEntries.count() - 1; i >= 0; i--) {
+        const Entry &entry = m_idleEntries.at(i);
+        if (entry.context == context && entry.size == size && entry.format == format) {
+            const Entry hit = m_idleEntries.takeAt(i);
+            m_entriesInUse.insert(hit.buffer, hit);
+            m_hitCount++;
+            tracepoint(qtmirserver, offscreenBufferAcquired, 1, m_totalBytes);
+            deleteDiscardedBuffers(context);
+            return hit.buffer;
+        }
+    }
+
+    const qint64 bytes = estimateBytes(size, format);
+    while (!m_idleEntries.isEmpty() && m_totalBytes + bytes > m_maxBytes) {
+        discard(m_idleEntries.takeFirst());
+    }
+    deleteDiscardedBuffers(context);
+
+    auto buffer = createBuffer(size, format);
+    m_entriesInUse.insert(buffer, Entry{buffer, context, size, format, bytes});
+    m_totalBytes += bytes;
+    m_missCount++;
+
+    qCDebug(QTMIR_SCREENS).nospace() << "FramebufferPool::acquire - new buffer of size " << size
+        << ", hit rate=" << qreal(m_hitCount) / (m_hitCount + m_missCount)
+        << ", total=" << m_totalBytes / 1024 << "KiB";
+    tracepoint(qtmirserver, offscreenBufferAcquired, 0, m_totalBytes);
+    return buffer;
+}
+
+void FramebufferPool::release(QOpenGLFramebufferObject *buffer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entriesInUse.find(buffer);
+    if (it == m_entriesInUse.end()) {
+        qCWarning(QTMIR_SCREENS) << "FramebufferPool::release - unknown buffer" << buffer;
+        return;
+    }
+
+    const Entry entry = it.value();
+    m_entriesInUse.erase(it);
+
+    if (!entry.context || m_totalBytes > m_maxBytes) {
+        discard(entry);
+    } else {
+        m_idleEntries.append(entry);
+    }
+}
+
+bool FramebufferPool::fitsCurrentContext(QOpenGLFramebufferObject *buffer) const
+{
+    QOpenGLContext *context = currentContext();
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entriesInUse.constFind(buffer);
+    return it != m_entriesInUse.constEnd() && it->context && it->context == context;
+}
+
+quint64 FramebufferPool::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+quint64 FramebufferPool::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_missCount;
+}
+
+qint64 FramebufferPool::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+QOpenGLContext *FramebufferPool::currentContext() const
+{
+    return QOpenGLContext::currentContext();
+}
+
+QOpenGLFramebufferObject *FramebufferPool::createBuffer(const QSize &size, const QOpenGLFramebufferObjectFormat &format)
+{
+    return new QOpenGLFramebufferObject(size, format);
+}
+
+void FramebufferPool::deleteBuffer(QOpenGLFramebufferObject *buffer)
+{
+    delete buffer;
+}
+
+void FramebufferPool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    Q_FOREACH (const Entry &entry, m_idleEntries) {
+        m_totalBytes -= entry.bytes;
+        deleteBuffer(entry.buffer);
+    }
+    m_idleEntries.clear();
+
+    Q_FOREACH (const Entry &entry, m_discardedEntries) {
+        deleteBuffer(entry.buffer);
+    }
+    m_discardedEntries.clear();
+}
+
+void FramebufferPool::discard(const Entry &entry)
+{
+    m_totalBytes -= entry.bytes;
+    m_discardedEntries.append(entry);
+}
+
+void FramebufferPool::deleteDiscardedBuffers(QOpenGLContext *context)
+{
+    auto it = m_discardedEntries.begin();
+    while (it != m_discardedEntries.end()) {
+        // Those whose context is gone can go from any thread rendering with GL
+        if (it->context == context || !it->context) {
+            deleteBuffer(it->buffer);
+            it = m_discardedEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FramebufferPool::watchContext(QOpenGLContext *context)
+{
+    if (m_contextConnections.contains(context)) {
+        return;
+    }
+
+    // A context created later on at the same address must not be handed the buffers of this one
+    m_contextConnections.insert(context, QObject::connect(context, &QOpenGLContext::aboutToBeDestroyed,
+        [this, context]() { forgetContext(context); }));
+}
+
+void FramebufferPool::forgetContext(QOpenGLContext *context)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QObject::disconnect(m_contextConnections.take(context));
+
+    for (int i = m_idleEntries.count() - 1; i >= 0; i--) {
+        if (m_idleEntries.at(i).context == context) {
+            const Entry entry = m_idleEntries.takeAt(i);
+            m_totalBytes -= entry.bytes;
+            deleteBuffer(entry.buffer);
+        }
+    }
+
+    deleteDiscardedBuffers(context);
+
+    for (auto it = m_entriesInUse.begin(); it != m_entriesInUse.end(); ++it) {
+        if (it->context == context) {
+            it->context = nullptr;
+        }
+    }
+}
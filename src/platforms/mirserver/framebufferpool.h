@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEBUFFERPOOL_H
+#define FRAMEBUFFERPOOL_H
+
+// Qt
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QOpenGLFramebufferObjectFormat>
+#include <QSize>
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+
+/*
+ * FramebufferPool recycles the framebuffer objects that OffscreenSurfaces render into.
+ *
+ * Offscreen surfaces come and go with QML layers, ShaderEffectSources and thumbnails, and tend to
+ * have the same few sizes. So instead of deleting its buffer, an OffscreenSurface hands it back
+ * here, and the next surface asking for a buffer of that size and format in the same GL context
+ * gets it.
+ *
+ * Buffers are kept per QOpenGLContext, as framebuffer objects can't be shared between contexts.
+ * The idle buffers of a context get deleted when it is about to be destroyed, and the ones it still
+ * had in use once released, by the next acquire() in any context.
+ *
+ * The pool caps the GPU memory taken by all the buffers it handed out plus the idle ones. When a
+ * new buffer would go over the cap, the least recently released idle buffers get deleted first.
+ * Buffers released while over the cap get deleted instead of kept. Setting
+ * QTMIR_OFFSCREEN_BUFFER_POOL_MB overrides the default cap of 64 MiB.
+ *
+ * Threading Note:
+ * acquire() must be called with a GL context current, from the thread it is current on, and returns
+ * null otherwise. release() can be called from any thread, as buffers only get deleted later on, by
+ * acquire() with their GL context current again, or with any context if theirs is gone.
+ */
+class FramebufferPool
+{
+public:
+    explicit FramebufferPool(qint64 maxBytes = defaultMaxBytes());
+    virtual ~FramebufferPool();
+
+    QOpenGLFramebufferObject *acquire(const QSize &size,
+                                      const QOpenGLFramebufferObjectFormat &format = QOpenGLFramebufferObjectFormat());
+    void release(QOpenGLFramebufferObject *buffer);
+
+    // Whether the buffer can be bound in the GL context current now: it was acquired in that very
+    // context, which has not been destroyed since
+    bool fitsCurrentContext(QOpenGLFramebufferObject *buffer) const;
+
+    // Number of acquire() calls served with an idle buffer, and with a new one
+    quint64 hitCount() const;
+    quint64 missCount() const;
+
+    // Estimated GPU memory taken by the buffers in use and the idle ones
+    qint64 totalBytes() const;
+
+    static qint64 defaultMaxBytes();
+
+protected:
+    // Overridden by tests, which have no GL to create buffers with
+    virtual QOpenGLContext *currentContext() const;
+    virtual QOpenGLFramebufferObject *createBuffer(const QSize &size, const QOpenGLFramebufferObjectFormat &format);
+    virtual void deleteBuffer(QOpenGLFramebufferObject *buffer);
+
+    // Deletes the idle buffers and the ones waiting for their context
+    void clear();
+
+private:
+    struct Entry {
+        QOpenGLFramebufferObject *buffer;
+        QOpenGLContext *context; // null once the context is gone
+        QSize size;
+        QOpenGLFramebufferObjectFormat format;
+        qint64 bytes;
+    };
+
+    void discard(const Entry &entry);
+    void deleteDiscardedBuffers(QOpenGLContext *context);
+    void watchContext(QOpenGLContext *context);
+    void forgetContext(QOpenGLContext *context);
+
+    const qint64 m_maxBytes;
+
+    mutable QMutex m_mutex;
+    QList<Entry> m_idleEntries; // least recently released first
+    QList<Entry> m_discardedEntries;
+    QHash<QOpenGLFramebufferObject*, Entry> m_entriesInUse;
+    QHash<QOpenGLContext*, QMetaObject::Connection> m_contextConnections;
+    qint64 m_totalBytes;
+    quint64 m_hitCount;
+    quint64 m_missCount;
+};
+
+#endif // FRAMEBUFFERPOOL_H
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frameclock.h"
+
+namespace {
+
+const qreal defaultRefreshRate = 60;
+
+// Weight of a new interval in the period estimate
+const int smoothing = 16;
+
+qint64 periodFor(qreal refreshRate)
+{
+    return qRound64(1000000000 / (refreshRate > 0 ? refreshRate : defaultRefreshRate));
+}
+
+} // namespace {
+
+FrameClock::FrameClock(qreal refreshRate)
+    : m_nominalPeriod(periodFor(refreshRate))
+    , m_period(m_nominalPeriod.load())
+{
+}
+
+void FrameClock::setRefreshRate(qreal refreshRate)
+{
+    const qint64 period = periodFor(refreshRate);
+    if (period != m_nominalPeriod) {
+        m_nominalPeriod = period;
+        m_period = period;
+    }
+}
+
+qreal FrameClock::refreshRate() const
+{
+    return 1e9 / m_period;
+}
+
+qint64 FrameClock::nextVsync(qint64 time) const
+{
+    const qint64 lastVsync = m_lastVsync;
+    const qint64 period = m_period;
+    if (lastVsync == 0 || time < lastVsync) {
+        return time;
+    }
+    return lastVsync + ((time - lastVsync) / period + 1) * period;
+}
+
+void FrameClock::framePosted(qint64 time)
+{
+    const qint64 lastVsync = m_lastVsync;
+    const qint64 period = m_period;
+
+    if (lastVsync == 0) {
+        m_lastVsync = time;
+        return;
+    }
+
+    const qint64 interval = time - lastVsync;
+    if (interval < period / 2) {
+        // Posting didn't wait for vsync, so this was no refresh of the screen
+        return;
+    }
+
+    if (interval <= period * 3 / 2) {
+        // Back to back frames, so the interval is a refresh period give or take some jitter.
+        // Only trusted close to the mode's period, else a few odd frames would drag it away.
+        const qint64 estimate = period + (interval - period) / smoothing;
+        const qint64 nominalPeriod = m_nominalPeriod;
+        m_period = qBound(nominalPeriod * 9 / 10, estimate, nominalPeriod * 11 / 10);
+    }
+
+    m_lastVsync = time;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/*
+ * FrameClock paces the render thread of a Screen at the screen's own refresh rate.
+ *
+ * It learns when vsyncs happen from the frames being posted, and refines the refresh period the
+ * display mode claims from the intervals seen between frames rendered back to back. Frames posted
+ * sooner than half a period after the previous one, as outputs not throttled by vsync allow, are
+ * not taken for vsyncs. The render thread itself is only ever held by the DisplayGroupScheduler.
+ *
+ * Threading Note:
+ * framePosted() is called from the render thread. Everything else can be called from any thread.
+ */
+class FrameClock
+{
+public:
+    explicit FrameClock(qreal refreshRate = 60);
+
+    // The refresh rate of the display mode. Starts the estimate over.
+    void setRefreshRate(qreal refreshRate);
+
+    // As estimated from the frames posted
+    qreal refreshRate() const;
+    qint64 period() const { return m_period; } // ns
+
+    qint64 lastVsync() const { return m_lastVsync; } // ns, monotonic, 0 if no frame posted yet
+    qint64 nextVsync(qint64 time) const;
+
+    // A frame got posted at the given time
+    void framePosted(qint64 time);
+
+private:
+    std::atomic<qint64> m_nominalPeriod;
+    std::atomic<qint64> m_period;
+    std::atomic<qint64> m_lastVsync{0};
+};
+
+#endif // FRAMECLOCK_H
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framereadback.h"
+#include "capturering.h"
+
+// Qt
+#include <QOpenGLContext>
+#include <QtGui/qopengl.h>
+
+// std
+#include <chrono>
+#include <cstring>
+
+using namespace qtmir;
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+
+namespace {
+
+bool contextSupportsAsynchronousReads(QOpenGLContext *context)
+{
+    if (!context) {
+        return false;
+    }
+    if (context->isOpenGLES()) {
+        return context->format().majorVersion() >= 3;
+    }
+    return context->format().version() >= qMakePair(3, 2)
+        || (context->hasExtension(QByteArrayLiteral("GL_ARB_sync"))
+            && (context->format().version() >= qMakePair(2, 1)
+                || context->hasExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"))));
+}
+
+qint64 monotonicNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void copyRows(uchar *destination, const uchar *source, int bytesPerLine, int height, bool flip)
+{
+    if (!flip) {
+        memcpy(destination, source, size_t(bytesPerLine) * height);
+        return;
+    }
+    for (int row = 0; row < height; ++row) {
+        memcpy(destination + size_t(row) * bytesPerLine, source + size_t(height - 1 - row) * bytesPerLine, bytesPerLine);
+    }
+}
+
+void flipRows(uchar *pixels, int bytesPerLine, int height)
+{
+    QByteArray swap(bytesPerLine, Qt::Uninitialized);
+    for (int row = 0; row < height / 2; ++row) {
+        uchar *top = pixels + size_t(row) * bytesPerLine;
+        uchar *bottom = pixels + size_t(height - 1 - row) * bytesPerLine;
+        memcpy(swap.data(), top, bytesPerLine);
+        memcpy(top, bottom, bytesPerLine);
+        memcpy(bottom, swap.constData(), bytesPerLine);
+    }
+}
+
+CapturedFrame describeFrame(const QSize &size, QImage::Format format, qint64 timestamp)
+{
+    CapturedFrame frame;
+    frame.size = size;
+    frame.bytesPerLine = size.width() * 4;
+    frame.format = format;
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+} // namespace {
+
+FrameReadback::FrameReadback(const std::shared_ptr<CaptureRing> &ring, int maxReadsInFlight)
+    : m_ring(ring)
+    , m_maxReadsInFlight(qMax(maxReadsInFlight, 1))
+{
+}
+
+FrameReadback::~FrameReadback()
+{
+    // Without a current context the fences are gone already, along with the context they were in
+    const bool contextCurrent = QOpenGLContext::currentContext();
+    Q_FOREACH (const Read &read, m_readsInFlight) {
+        if (contextCurrent) {
+            m_deleteSync(read.fence);
+        }
+        delete read.pixelBuffer;
+        read.handler(nullptr);
+    }
+    qDeleteAll(m_idlePixelBuffers);
+}
+
+bool FrameReadback::read(const QSize &size, QImage::Format format, bool bottomUp, const FrameHandler &handler)
+{
+    if (size.isEmpty()) {
+        return false;
+    }
+
+    const qint64 timestamp = monotonicNanoseconds();
+
+    if (!resolveFunctions()) {
+        readNow(size, format, bottomUp, timestamp, handler);
+        return true;
+    }
+
+    if (m_readsInFlight.count() >= m_maxReadsInFlight) {
+        return false;
+    }
+
+    QOpenGLBuffer *pixelBuffer;
+    if (!m_idlePixelBuffers.isEmpty()) {
+        pixelBuffer = m_idlePixelBuffers.takeLast();
+    } else {
+        pixelBuffer = new QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer);
+        if (!pixelBuffer->create()) {
+            delete pixelBuffer;
+            readNow(size, format, bottomUp, timestamp, handler);
+            return true;
+        }
+        pixelBuffer->setUsagePattern(QOpenGLBuffer::StreamRead);
+    }
+
+    pixelBuffer->bind();
+    pixelBuffer->allocate(size.width() * size.height() * 4);
+
+    // Returns as soon as the copy is queued, as it goes to a buffer object rather than to memory
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    // Leave no pixel pack buffer bound, or later reads by others would land in it
+    QOpenGLBuffer::release(QOpenGLBuffer::PixelPackBuffer);
+
+    void *fence = m_fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_readsInFlight.append(Read{pixelBuffer, fence, size, format, bottomUp, timestamp, handler});
+    return true;
+}
+
+bool FrameReadback::collect()
+{
+    while (!m_readsInFlight.isEmpty()) {
+        // Polls, as the timeout is 0. Also makes sure the fence gets to the GPU at some point.
+        const GLenum status = m_clientWaitSync(m_readsInFlight.first().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+
+        const Read read = m_readsInFlight.takeFirst();
+        m_deleteSync(read.fence);
+
+        const int byteCount = read.size.width() * read.size.height() * 4;
+        read.pixelBuffer->bind();
+        const uchar *pixels = nullptr;
+        if (status != GL_WAIT_FAILED) {
+            pixels = static_cast<const uchar*>(read.pixelBuffer->mapRange(0, byteCount, QOpenGLBuffer::RangeRead));
+        }
+
+        std::shared_ptr<const CapturedFrame> frame;
+        int slot;
+        uchar *destination = pixels ? m_ring->claim(byteCount, &slot) : nullptr;
+        if (destination) {
+            copyRows(destination, pixels, read.size.width() * 4, read.size.height(), read.bottomUp);
+            frame = m_ring->publish(slot, describeFrame(read.size, read.format, read.timestamp));
+        }
+
+        if (pixels) {
+            read.pixelBuffer->unmap();
+        }
+        QOpenGLBuffer::release(QOpenGLBuffer::PixelPackBuffer);
+        m_idlePixelBuffers.append(read.pixelBuffer);
+
+        read.handler(frame);
+    }
+
+    return hasReadsInFlight();
+}
+
+bool FrameReadback::resolveFunctions()
+{
+    if (m_functionsResolved) {
+        return m_asynchronous;
+    }
+    m_functionsResolved = true;
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (contextSupportsAsynchronousReads(context)) {
+        m_fenceSync = reinterpret_cast<decltype(m_fenceSync)>(context->getProcAddress("glFenceSync"));
+        m_clientWaitSync = reinterpret_cast<decltype(m_clientWaitSync)>(context->getProcAddress("glClientWaitSync"));
+        m_deleteSync = reinterpret_cast<decltype(m_deleteSync)>(context->getProcAddress("glDeleteSync"));
+        m_asynchronous = m_fenceSync && m_clientWaitSync && m_deleteSync;
+    }
+    return m_asynchronous;
+}
+
+void FrameReadback::readNow(const QSize &size, QImage::Format format, bool bottomUp, qint64 timestamp,
+                            const FrameHandler &handler)
+{
+    const int bytesPerLine = size.width() * 4;
+
+    int slot;
+    uchar *destination = m_ring->claim(size_t(bytesPerLine) * size.height(), &slot);
+    if (!destination) {
+        handler(nullptr);
+        return;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, destination);
+    if (bottomUp) {
+        flipRows(destination, bytesPerLine, size.height());
+    }
+
+    handler(m_ring->publish(slot, describeFrame(size, format, timestamp)));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEREADBACK_H
+#define FRAMEREADBACK_H
+
+#include "framecaptureinterface.h"
+
+// Qt
+#include <QList>
+#include <QOpenGLBuffer>
+#include <QSize>
+
+#include <memory>
+
+class CaptureRing;
+
+/*
+ * FrameReadback reads frames back from the GPU into a CaptureRing, without waiting for the GPU.
+ *
+ * read() only queues the copy of the bound framebuffer into a pixel pack buffer, followed by a
+ * fence. collect(), called again on later frames, moves the pixels of the copies whose fence got
+ * signalled into the ring and hands the frames over. A read() while the maximum number of copies
+ * is in flight gets refused rather than waited for.
+ *
+ * GL contexts lacking pixel pack buffers or fences (OpenGL ES 2) get the pixels read right away,
+ * which does wait for the GPU.
+ *
+ * Threading Note:
+ * Must be used from the thread of the GL context it reads from, with that context current. Also
+ * applies to its destruction.
+ */
+class FrameReadback
+{
+public:
+    explicit FrameReadback(const std::shared_ptr<CaptureRing> &ring, int maxReadsInFlight = 2);
+    ~FrameReadback();
+
+    // Reads the bottom left area of the given size off the bound framebuffer. Rows of window
+    // framebuffers go from bottom to top, and get flipped when bottomUp is set. The handler gets
+    // called once, with a null frame if the read failed. Returns false if it got refused, in
+    // which case the handler isn't called.
+    bool read(const QSize &size, QImage::Format format, bool bottomUp, const qtmir::FrameHandler &handler);
+
+    // Hands over the frames done reading back. Returns whether reads are still in flight.
+    bool collect();
+
+    bool hasReadsInFlight() const { return !m_readsInFlight.isEmpty(); }
+
+private:
+    struct Read {
+        QOpenGLBuffer *pixelBuffer;
+        void *fence; // GLsync
+        QSize size;
+        QImage::Format format;
+        bool bottomUp;
+        qint64 timestamp;
+        qtmir::FrameHandler handler;
+    };
+
+    bool resolveFunctions();
+    void finish(const Read &read, const uchar *pixels);
+    void readNow(const QSize &size, QImage::Format format, bool bottomUp, qint64 timestamp,
+                 const qtmir::FrameHandler &handler);
+
+    const std::shared_ptr<CaptureRing> m_ring;
+    const int m_maxReadsInFlight;
+    QList<Read> m_readsInFlight; // oldest first
+    QList<QOpenGLBuffer*> m_idlePixelBuffers;
+
+    bool m_functionsResolved{false};
+    bool m_asynchronous{false};
+    void *(*m_fenceSync)(unsigned int, unsigned int){nullptr};
+    unsigned int (*m_clientWaitSync)(void *, unsigned int, quint64){nullptr};
+    void (*m_deleteSync)(void *){nullptr};
+};
+
+#endif // FRAMEREADBACK_H
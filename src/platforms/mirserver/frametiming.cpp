@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frametiming.h"
+
+// Qt
+#include <QtMath>
+
+#include <chrono>
+
+namespace {
+
+int mostSignificantBit(quint64 value)
+{
+    return 63 - __builtin_clzll(value);
+}
+
+const char *const phaseNames[FrameTiming::PhaseCount] = { "sync", "render", "swap", "vsyncWait" };
+
+} // namespace {
+
+const int FrameTimingHistogram::bucketCount;
+
+FrameTimingHistogram::FrameTimingHistogram()
+{
+    for (auto &bucket : m_buckets) {
+        bucket = 0;
+    }
+}
+
+void FrameTimingHistogram::record(qint64 nanoseconds)
+{
+    if (nanoseconds < 0) {
+        return;
+    }
+
+    m_buckets[bucketFor(nanoseconds / 1000)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    qint64 maximum = m_maximum.load(std::memory_order_relaxed);
+    while (nanoseconds > maximum
+           && !m_maximum.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 FrameTimingHistogram::mean() const
+{
+    const quint64 count = m_count;
+    return count ? m_sum / count : 0;
+}
+
+qint64 FrameTimingHistogram::percentile(double fraction) const
+{
+    const quint64 count = m_count;
+    if (count == 0) {
+        return 0;
+    }
+
+    const quint64 rank = qMax<quint64>(1, qCeil(count * fraction));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < bucketCount - 1; ++bucket) {
+        seen += m_buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return qMin(bucketLowerBound(bucket + 1) * 1000, maximum());
+        }
+    }
+    return maximum();
+}
+
+// Below 4 µs, a bucket per µs. Above, 4 buckets per power of two.
+int FrameTimingHistogram::bucketFor(qint64 microseconds)
+{
+    if (microseconds < 4) {
+        return qMax<qint64>(0, microseconds);
+    }
+
+    const int msb = mostSignificantBit(microseconds);
+    const int bucket = 4 * (msb - 1) + ((microseconds >> (msb - 2)) & 3);
+    return qMin(bucket, bucketCount - 1);
+}
+
+qint64 FrameTimingHistogram::bucketLowerBound(int bucket)
+{
+    if (bucket < 4) {
+        return bucket;
+    }
+    return qint64(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+qint64 FrameTiming::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameTiming::syncStarted(qint64 time)
+{
+    m_frameStarted = time;
+    m_marks[Sync * 2] = time;
+}
+
+void FrameTiming::syncFinished(qint64 time)
+{
+    m_marks[Sync * 2 + 1] = time;
+}
+
+void FrameTiming::renderStarted(qint64 time)
+{
+    m_marks[Render * 2] = time;
+}
+
+void FrameTiming::renderFinished(qint64 time)
+{
+    m_marks[Render * 2 + 1] = time;
+}
+
+void FrameTiming::swapStarted(qint64 time)
+{
+    if (!m_frameStarted) {
+        m_frameStarted = time;
+    }
+    m_marks[Swap * 2] = time;
+}
+
+void FrameTiming::swapFinished(qint64 time)
+{
+    m_marks[Swap * 2 + 1] = time;
+    m_marks[VsyncWait * 2] = time;
+}
+
+FrameTiming::Frame FrameTiming::framePosted(qint64 time, qint64 refreshPeriod)
+{
+    m_marks[VsyncWait * 2 + 1] = time;
+
+    Frame frame;
+    for (int phase = 0; phase < PhaseCount; ++phase) {
+        const qint64 start = m_marks[phase * 2];
+        const qint64 end = m_marks[phase * 2 + 1];
+        frame.durations[phase] = start && end >= start ? end - start : -1;
+        m_histograms[phase].record(frame.durations[phase]);
+    }
+
+    frame.missedVsyncs = 0;
+    if (refreshPeriod > 0 && m_lastPosted && m_frameStarted - m_lastPosted < refreshPeriod) {
+        // Rounded, as vsync intervals jitter a bit
+        frame.missedVsyncs = qMax<qint64>(0, (time - m_lastPosted + refreshPeriod / 2) / refreshPeriod - 1);
+    }
+
+    m_frameCount.fetch_add(1, std::memory_order_relaxed);
+    m_missedVsyncCount.fetch_add(frame.missedVsyncs, std::memory_order_relaxed);
+
+    frame.unblankLatency = -1;
+    const qint64 exposedTime = m_exposedTime.exchange(0);
+    if (exposedTime) {
+        frame.unblankLatency = time - exposedTime;
+        m_lastUnblankWarm = m_exposedWarm.load();
+        m_lastUnblankLatency = frame.unblankLatency;
+    }
+
+    m_lastPosted = time;
+    m_frameStarted = 0;
+    for (auto &mark : m_marks) {
+        mark = 0;
+    }
+
+    return frame;
+}
+
+void FrameTiming::exposed(qint64 time, bool warm)
+{
+    m_exposedWarm = warm;
+    m_exposedTime = time;
+}
+
+QVariantMap FrameTiming::toVariantMap() const
+{
+    const qint64 unblankLatency = lastUnblankLatency();
+
+    QVariantMap map;
+    map.insert(QStringLiteral("frames"), frameCount());
+    map.insert(QStringLiteral("missedVsyncs"), missedVsyncCount());
+    map.insert(QStringLiteral("unblankLatency"), unblankLatency < 0 ? unblankLatency : unblankLatency / 1000);
+    map.insert(QStringLiteral("unblankWarm"), lastUnblankWarm());
+
+    for (int phase = 0; phase < PhaseCount; ++phase) {
+        const FrameTimingHistogram &histogram = m_histograms[phase];
+        QVariantMap phaseMap;
+        phaseMap.insert(QStringLiteral("mean"), histogram.mean() / 1000);
+        phaseMap.insert(QStringLiteral("p50"), histogram.percentile(0.5) / 1000);
+        phaseMap.insert(QStringLiteral("p99"), histogram.percentile(0.99) / 1000);
+        phaseMap.insert(QStringLiteral("max"), histogram.maximum() / 1000);
+        map.insert(QLatin1String(phaseNames[phase]), phaseMap);
+    }
+
+    return map;
+}
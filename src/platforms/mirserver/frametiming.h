@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMETIMING_H
+#define FRAMETIMING_H
+
+// Qt
+#include <QVariantMap>
+
+#include <atomic>
+
+/*
+ * FrameTimingHistogram counts durations into buckets a quarter of a power of two wide, from 1 µs
+ * up to about a second, longer ones going into the last bucket.
+ *
+ * Recording is lock-free, so the render thread never waits for whoever reads the results. Reads
+ * aren't a consistent snapshot, which is fine for statistics.
+ */
+class FrameTimingHistogram
+{
+public:
+    static const int bucketCount = 80;
+
+    FrameTimingHistogram();
+
+    void record(qint64 nanoseconds);
+
+    quint64 count() const { return m_count; }
+    qint64 maximum() const { return m_maximum; } // ns
+    qint64 mean() const; // ns
+
+    // Upper bound, in ns, of the bucket reached by the given fraction of the durations recorded
+    qint64 percentile(double fraction) const;
+
+    static int bucketFor(qint64 microseconds);
+    static qint64 bucketLowerBound(int bucket); // µs
+
+private:
+    std::atomic<quint32> m_buckets[bucketCount];
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_maximum{0};
+};
+
+/*
+ * FrameTiming measures where the frames of a Screen spend their time: syncing the scene graph,
+ * rendering it, swapping buffers, and then blocking until the display group got posted, which is
+ * mostly waiting for vsync.
+ *
+ * A vsync counts as missed when a frame was started right after the previous one got posted, so
+ * rendering was continuous, yet it got posted more than one refresh period after it. Frames coming
+ * after idle time are never late.
+ *
+ * Threading Note:
+ * The marks are set from the render thread. Results can be read from any thread.
+ */
+class FrameTiming
+{
+public:
+    enum Phase { Sync, Render, Swap, VsyncWait, PhaseCount };
+
+    struct Frame {
+        qint64 durations[PhaseCount]; // ns, -1 for the phases not seen
+        int missedVsyncs;
+        qint64 unblankLatency; // ns since exposed(), -1 unless the first frame after it
+    };
+
+    static qint64 now(); // ns, monotonic
+
+    // Render thread, in frame order. The sync and render marks come from QQuickWindow, so other
+    // windows only get the swap and vsync phases.
+    void syncStarted(qint64 time);
+    void syncFinished(qint64 time);
+    void renderStarted(qint64 time);
+    void renderFinished(qint64 time);
+    void swapStarted(qint64 time);
+    void swapFinished(qint64 time);
+    Frame framePosted(qint64 time, qint64 refreshPeriod);
+
+    // GUI thread, when the screen's window gets exposed again. The next frame posted tells how long
+    // it took to get back on screen, and whether the scene graph was kept warm meanwhile.
+    void exposed(qint64 time, bool warm);
+
+    const FrameTimingHistogram &histogram(Phase phase) const { return m_histograms[phase]; }
+    quint64 frameCount() const { return m_frameCount; }
+    quint64 missedVsyncCount() const { return m_missedVsyncCount; }
+    qint64 lastUnblankLatency() const { return m_lastUnblankLatency; } // ns, -1 if none yet
+    bool lastUnblankWarm() const { return m_lastUnblankWarm; }
+
+    // Durations in µs: {frames, missedVsyncs, unblankLatency, unblankWarm,
+    //                   sync: {mean, p50, p99, max}, render: ..., swap: ..., vsyncWait: ...}
+    QVariantMap toVariantMap() const;
+
+private:
+    // Only touched by the render thread
+    qint64 m_marks[PhaseCount * 2] = {};
+    qint64 m_frameStarted{0};
+    qint64 m_lastPosted{0};
+
+    FrameTimingHistogram m_histograms[PhaseCount];
+    std::atomic<quint64> m_frameCount{0};
+    std::atomic<quint64> m_missedVsyncCount{0};
+
+    std::atomic<qint64> m_exposedTime{0};
+    std::atomic<bool> m_exposedWarm{false};
+    std::atomic<qint64> m_lastUnblankLatency{-1};
+    std::atomic<bool> m_lastUnblankWarm{false};
+};
+
+#endif // FRAMETIMING_H
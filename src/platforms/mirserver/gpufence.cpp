@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gpufence.h"
+
+// Qt
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+// EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+
+namespace {
+
+struct Functions
+{
+    PFNEGLCREATESYNCKHRPROC createSync{nullptr};
+    PFNEGLDESTROYSYNCKHRPROC destroySync{nullptr};
+    PFNEGLWAITSYNCKHRPROC waitSync{nullptr};
+};
+
+bool hasExtension(const char *extensions, const char *name)
+{
+    const size_t length = strlen(name);
+    for (const char *found = strstr(extensions, name); found; found = strstr(found + length, name)) {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Resolved once, the same for all contexts of the display
+const Functions &functions(EGLDisplay display)
+{
+    static const Functions resolved = [display]() {
+        Functions f;
+        const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (extensions && hasExtension(extensions, "EGL_KHR_fence_sync")
+                && hasExtension(extensions, "EGL_KHR_wait_sync")) {
+            f.createSync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+            f.destroySync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+            f.waitSync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"));
+            if (!f.createSync || !f.destroySync || !f.waitSync) {
+                f = Functions();
+            }
+        }
+        return f;
+    }();
+    return resolved;
+}
+
+} // namespace {
+
+GpuFence::GpuFence()
+    : m_display(EGL_NO_DISPLAY)
+    , m_sync(EGL_NO_SYNC_KHR)
+{
+}
+
+GpuFence::~GpuFence()
+{
+    reset();
+}
+
+bool GpuFence::insert()
+{
+    reset();
+
+    const EGLDisplay display = eglGetCurrentDisplay();
+    const Functions &f = functions(display);
+    if (f.createSync) {
+        m_sync = f.createSync(display, EGL_SYNC_FENCE_KHR, nullptr);
+        if (m_sync != EGL_NO_SYNC_KHR) {
+            m_display = display;
+        }
+    }
+
+    // Gets the fence, or at least the commands before it, to the GPU
+    QOpenGLContext::currentContext()->functions()->glFlush();
+
+    return m_sync != EGL_NO_SYNC_KHR;
+}
+
+void GpuFence::waitOnGpu()
+{
+    if (m_sync != EGL_NO_SYNC_KHR) {
+        functions(m_display).waitSync(m_display, m_sync, 0);
+    }
+}
+
+void GpuFence::reset()
+{
+    // Commands already waiting on the fence keep it alive as long as they need it
+    if (m_sync != EGL_NO_SYNC_KHR) {
+        functions(m_display).destroySync(m_display, m_sync);
+        m_sync = EGL_NO_SYNC_KHR;
+        m_display = EGL_NO_DISPLAY;
+    }
+}
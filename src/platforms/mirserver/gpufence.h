@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPUFENCE_H
+#define GPUFENCE_H
+
+/*
+ * GpuFence orders GL commands across contexts without blocking any thread.
+ *
+ * insert() puts a fence after the commands issued so far in the current context. waitOnGpu(), with
+ * another context current, makes the GPU hold the commands issued next in that context until the
+ * fence signals, while the calling thread goes on. A glFinish() or a client side wait would
+ * instead stall the render thread until the GPU catches up.
+ *
+ * Relies on EGL_KHR_fence_sync and EGL_KHR_wait_sync. Without those, insert() only flushes, which
+ * most drivers order by anyway.
+ *
+ * Threading Note:
+ * Lives in a render thread. Contexts waiting on the fence have to share the EGL display it was
+ * inserted in.
+ */
+class GpuFence
+{
+public:
+    GpuFence();
+    ~GpuFence();
+
+    // Returns false if the fence fell back to a flush
+    bool insert();
+    void waitOnGpu();
+
+private:
+    void reset();
+
+    void *m_display; // EGLDisplay
+    void *m_sync; // EGLSyncKHR
+};
+
+#endif // GPUFENCE_H
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hardwarecursor.h"
+#include "logging.h"
+
+// Mir
+#include <mir/graphics/cursor_image.h>
+
+// xcursor
+#include <X11/Xcursor/Xcursor.h>
+
+#include <vector>
+
+namespace mg = mir::graphics;
+using namespace qtmir;
+
+namespace {
+
+std::weak_ptr<HardwareCursor> hardwareCursorInstance;
+
+class ArgbCursorImage : public mg::CursorImage
+{
+public:
+    ArgbCursorImage(const uint32_t *pixels, int width, int height, int hotspotX, int hotspotY)
+        : m_pixels(pixels, pixels + width * height)
+        , m_size{width, height}
+        , m_hotspot{hotspotX, hotspotY}
+    {
+    }
+
+    const void *as_argb_8888() const override { return m_pixels.data(); }
+    mir::geometry::Size size() const override { return m_size; }
+    mir::geometry::Displacement hotspot() const override { return m_hotspot; }
+
+private:
+    const std::vector<uint32_t> m_pixels;
+    const mir::geometry::Size m_size;
+    const mir::geometry::Displacement m_hotspot;
+};
+
+int cursorSizeFromEnvironment()
+{
+    bool ok;
+    const int size = qgetenv("XCURSOR_SIZE").toInt(&ok);
+    return ok && size > 0 ? size : 24;
+}
+
+} // namespace {
+
+bool HardwareCursor::isEnabled()
+{
+    static const bool enabled = qgetenv("QTMIR_HARDWARE_CURSOR") == "1";
+    return enabled;
+}
+
+std::shared_ptr<HardwareCursor> HardwareCursor::instance()
+{
+    return hardwareCursorInstance.lock();
+}
+
+std::shared_ptr<HardwareCursor> HardwareCursor::create(const std::shared_ptr<mg::Cursor> &wrapped)
+{
+    auto cursor = std::make_shared<HardwareCursor>(wrapped);
+    hardwareCursorInstance = cursor;
+    return cursor;
+}
+
+HardwareCursor::HardwareCursor(const std::shared_ptr<mg::Cursor> &wrapped)
+    : m_wrapped(wrapped)
+    , m_themeName(qEnvironmentVariableIsEmpty("XCURSOR_THEME") ? QByteArray("default") : qgetenv("XCURSOR_THEME"))
+    , m_size(cursorSizeFromEnvironment())
+{
+    m_wrapped->hide();
+}
+
+bool HardwareCursor::showNamed(const QByteArray &name)
+{
+    auto iterator = m_namedCursors.constFind(name);
+    if (iterator == m_namedCursors.constEnd()) {
+        iterator = m_namedCursors.insert(name, loadNamed(name));
+    }
+
+    const std::shared_ptr<mg::CursorImage> &image = iterator.value();
+    if (!image) {
+        conceal();
+        return false;
+    }
+
+    m_wrapped->show(*image);
+    m_shown = true;
+    return true;
+}
+
+void HardwareCursor::showImage(const QImage &image, const QPoint &hotspot)
+{
+    const QImage argbImage = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    ArgbCursorImage cursorImage(reinterpret_cast<const uint32_t*>(argbImage.constBits()),
+                                argbImage.width(), argbImage.height(), hotspot.x(), hotspot.y());
+    m_wrapped->show(cursorImage);
+    m_shown = true;
+}
+
+void HardwareCursor::conceal()
+{
+    if (m_shown) {
+        m_wrapped->hide();
+        m_shown = false;
+    }
+}
+
+QPoint HardwareCursor::position() const
+{
+    return QPoint(m_x, m_y);
+}
+
+void HardwareCursor::move_to(mir::geometry::Point position)
+{
+    m_x = position.x.as_int();
+    m_y = position.y.as_int();
+    m_wrapped->move_to(position);
+}
+
+std::shared_ptr<mg::CursorImage> HardwareCursor::loadNamed(const QByteArray &name)
+{
+    XcursorImage *xcursorImage = XcursorLibraryLoadImage(name.constData(), m_themeName.constData(), m_size);
+    if (!xcursorImage) {
+        qCDebug(QTMIR_MIR_INPUT) << "HardwareCursor: no" << name << "cursor in the" << m_themeName << "theme";
+        return nullptr;
+    }
+
+    auto image = std::make_shared<ArgbCursorImage>(xcursorImage->pixels, xcursorImage->width, xcursorImage->height,
+                                                   xcursorImage->xhot, xcursorImage->yhot);
+    XcursorImageDestroy(xcursorImage);
+    return image;
+}
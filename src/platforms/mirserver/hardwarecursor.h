@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_HARDWARECURSOR_H
+#define QTMIR_HARDWARECURSOR_H
+
+#include <mir/graphics/cursor.h>
+
+// Qt
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+
+#include <atomic>
+#include <memory>
+
+namespace qtmir {
+
+/*
+    Draws the mouse pointer on the hardware cursor plane, in place of shell's QML MousePointer.
+
+    Wraps Mir's cursor. What Mir itself asks it to show is ignored, as is the case when QML draws
+    the pointer: qtmir::Cursor decides which cursor to show, from the same names and QCursors the
+    QML MousePointer would get. Named cursors are loaded from the xcursor theme set by XCURSOR_THEME
+    and XCURSOR_SIZE, once each.
+
+    Moving the pointer then costs no scene graph frame. Enabled by setting QTMIR_HARDWARE_CURSOR=1.
+
+    Threading Note:
+    move_to() is called from Mir's input thread, everything else from Qt's GUI thread.
+ */
+class HardwareCursor : public mir::graphics::Cursor
+{
+public:
+    static bool isEnabled();
+
+    // The one wrapping Mir's cursor, if any
+    static std::shared_ptr<HardwareCursor> instance();
+    static std::shared_ptr<HardwareCursor> create(const std::shared_ptr<mir::graphics::Cursor> &wrapped);
+
+    explicit HardwareCursor(const std::shared_ptr<mir::graphics::Cursor> &wrapped);
+
+    // Returns false, showing nothing, if the theme has no such cursor
+    bool showNamed(const QByteArray &name);
+    // Images in QImage::Format_ARGB32_Premultiplied are shown without being converted first
+    void showImage(const QImage &image, const QPoint &hotspot);
+    void conceal();
+
+    bool isShown() const { return m_shown; }
+
+    // Where Mir last moved the pointer to
+    QPoint position() const;
+
+    // mir::graphics::Cursor
+    void show() override {}
+    void show(mir::graphics::CursorImage const&) override {}
+    void hide() override {}
+    void move_to(mir::geometry::Point position) override;
+
+private:
+    std::shared_ptr<mir::graphics::CursorImage> loadNamed(const QByteArray &name);
+
+    const std::shared_ptr<mir::graphics::Cursor> m_wrapped;
+    const QByteArray m_themeName;
+    const int m_size;
+
+    QHash<QByteArray, std::shared_ptr<mir::graphics::CursorImage>> m_namedCursors; // null if not in the theme
+    bool m_shown{false};
+
+    std::atomic<int> m_x{0};
+    std::atomic<int> m_y{0};
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_HARDWARECURSOR_H
@@ -18,10 +18,12 @@
 
 #include <mir/graphics/buffer.h>
 #include <mir/renderer/gl/texture_source.h>
+#include <mir/renderer/sw/pixel_source.h>
 
 #include <stdexcept>
 
 using mir::renderer::gl::TextureSource;
+using mir::renderer::software::PixelSource;
 
 miral::GLBuffer::GLBuffer() = default;
 miral::GLBuffer::~GLBuffer() = default;
@@ -52,6 +54,16 @@ mir::geometry::Size miral::GLBuffer::size() const
     return wrapped->size();
 }
 
+MirPixelFormat miral::GLBuffer::pixel_format() const
+{
+    return wrapped->pixel_format();
+}
+
+std::shared_ptr<mir::graphics::Buffer> miral::GLBuffer::buffer() const
+{
+    return wrapped;
+}
+
 void miral::GLBuffer::reset()
 {
     wrapped.reset();
@@ -68,3 +80,40 @@ void miral::GLBuffer::bind_to_texture()
         throw std::logic_error("Buffer does not support GL rendering");
     }
 }
+
+void miral::GLBuffer::bind()
+{
+    if (auto const texture_source = dynamic_cast<TextureSource*>(wrapped->native_buffer_base()))
+    {
+        texture_source->bind();
+    }
+    else
+    {
+        throw std::logic_error("Buffer does not support GL rendering");
+    }
+}
+
+void miral::GLBuffer::secure_for_render()
+{
+    if (auto const texture_source = dynamic_cast<TextureSource*>(wrapped->native_buffer_base()))
+    {
+        texture_source->secure_for_render();
+    }
+}
+
+bool miral::GLBuffer::can_read_pixels() const
+{
+    return dynamic_cast<PixelSource*>(wrapped->native_buffer_base()) != nullptr;
+}
+
+bool miral::GLBuffer::read_pixels(
+    std::function<void(unsigned char const* pixels, mir::geometry::Stride stride)> const& do_with_pixels)
+{
+    auto const pixel_source = dynamic_cast<PixelSource*>(wrapped->native_buffer_base());
+    if (!pixel_source)
+        return false;
+
+    auto const stride = pixel_source->stride();
+    pixel_source->read([&](unsigned char const* pixels) { do_with_pixels(pixels, stride); });
+    return true;
+}
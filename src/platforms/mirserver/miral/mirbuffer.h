@@ -17,8 +17,11 @@
 #ifndef MIRAL_GLBUFFER_H
 #define MIRAL_GLBUFFER_H
 
+#include <mir/geometry/dimensions.h>
 #include <mir/geometry/size.h>
+#include <mir_toolkit/common.h>
 
+#include <functional>
 #include <memory>
 
 namespace mir { namespace graphics { class Buffer; }}
@@ -35,11 +38,28 @@ public:
     operator bool() const;
     bool has_alpha_channel() const;
     mir::geometry::Size size() const;
+    MirPixelFormat pixel_format() const;
+    std::shared_ptr<mir::graphics::Buffer> buffer() const;
 
     void reset();
     void reset(std::shared_ptr<mir::graphics::Buffer> const& buffer);
     void bind_to_texture();
 
+    /// Binds the buffer to the texture it was imported into before, making sure the texture shows
+    /// what the client rendered into the buffer since, once the GPU samples it
+    void bind();
+
+    /// Gives the buffer a release fence after the rendering commands issued so far, for the client
+    /// to wait on before rendering into the buffer again
+    void secure_for_render();
+
+    /// Whether the buffer lives in client memory, with its pixels changing in place
+    bool can_read_pixels() const;
+
+    /// Gives access to the pixels of buffers living in client memory (software rendered clients).
+    /// \return false, without calling do_with_pixels, for buffers without CPU accessible pixels
+    bool read_pixels(std::function<void(unsigned char const* pixels, mir::geometry::Stride stride)> const& do_with_pixels);
+
 private:
     std::shared_ptr<mir::graphics::Buffer> wrapped;
 };
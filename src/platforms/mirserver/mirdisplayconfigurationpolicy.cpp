@@ -29,6 +29,9 @@ namespace mg = mir::graphics;
 #define ENV_GRID_UNIT_PX "GRID_UNIT_PX"
 #define DEFAULT_GRID_UNIT_PX 8
 
+// Rotates all outputs, counter-clockwise, by 0, 90, 180 or 270 degrees
+#define ENV_OUTPUT_ORIENTATION "QTMIR_OUTPUT_ORIENTATION"
+
 namespace {
 class MirDisplayConfigurationPolicy : public mir::graphics::DisplayConfigurationPolicy
 {
@@ -40,6 +43,8 @@ public:
 private:
     const std::shared_ptr<mir::graphics::DisplayConfigurationPolicy> m_wrapped;
     float m_defaultScale;
+    bool m_overrideOrientation;
+    MirOrientation m_orientation;
 };
 
 static float getenvFloat(const char* name, float defaultValue)
@@ -53,12 +58,25 @@ static float getenvFloat(const char* name, float defaultValue)
 MirDisplayConfigurationPolicy::MirDisplayConfigurationPolicy(
         const std::shared_ptr<mir::graphics::DisplayConfigurationPolicy> &wrapped)
     : m_wrapped(wrapped)
+    , m_overrideOrientation(false)
+    , m_orientation(mir_orientation_normal)
 {
     float gridUnit = DEFAULT_GRID_UNIT_PX;
     if (qEnvironmentVariableIsSet(ENV_GRID_UNIT_PX)) {
         gridUnit = getenvFloat(ENV_GRID_UNIT_PX, DEFAULT_GRID_UNIT_PX);
     }
     m_defaultScale = gridUnit / DEFAULT_GRID_UNIT_PX;
+
+    if (qEnvironmentVariableIsSet(ENV_OUTPUT_ORIENTATION)) {
+        bool ok;
+        const int degrees = qgetenv(ENV_OUTPUT_ORIENTATION).toInt(&ok);
+        if (ok && degrees >= 0 && degrees < 360 && degrees % 90 == 0) {
+            m_overrideOrientation = true;
+            m_orientation = static_cast<MirOrientation>(degrees);
+        } else {
+            qWarning("Ignoring %s, which should be 0, 90, 180 or 270", ENV_OUTPUT_ORIENTATION);
+        }
+    }
 }
 
 void MirDisplayConfigurationPolicy::apply_to(mg::DisplayConfiguration &conf)
@@ -95,8 +113,17 @@ void MirDisplayConfigurationPolicy::apply_to(mg::DisplayConfiguration &conf)
                 return;
             }
 
+            if (m_overrideOrientation) {
+                output.orientation = m_orientation;
+            }
+
+            // Outputs turned sideways are as wide as their mode is high
+            const auto modeSize = output.modes[output.current_mode_index].size;
+            const bool sideways = output.orientation == mir_orientation_left
+                    || output.orientation == mir_orientation_right;
+
             output.top_left = mir::geometry::Point{nextTopLeftPosition, 0};
-            nextTopLeftPosition += output.modes[output.current_mode_index].size.width.as_int();
+            nextTopLeftPosition += sideways ? modeSize.height.as_int() : modeSize.width.as_int();
 
             if (phoneDetected) {
                 if (screenCount == 1 || output.type == mg::DisplayConfigurationOutputType::lvds) {
@@ -22,7 +22,6 @@
 
 #include <QDebug>
 
-#include <QOpenGLFramebufferObject>
 #include <QSurfaceFormat>
 #include <QtPlatformSupport/private/qeglconvenience_p.h>
 #include <QtGui/private/qopenglcontext_p.h>
@@ -143,12 +142,7 @@ static bool needsFBOReadBackWorkaround()
 bool MirOpenGLContext::makeCurrent(QPlatformSurface *surface)
 {
     if (surface->surface()->surfaceClass() == QSurface::Offscreen) {
-        auto offscreen = static_cast<OffscreenSurface *>(surface);
-        if (!offscreen->buffer()) {
-            auto buffer = new QOpenGLFramebufferObject(surface->surface()->size());
-            offscreen->setBuffer(buffer);
-        }
-        return offscreen->buffer()->bind();
+        return static_cast<OffscreenSurface *>(surface)->bindBuffer();
     }
 
     // ultimately calls Mir's DisplayBuffer::make_current()
@@ -182,6 +176,16 @@ void MirOpenGLContext::doneCurrent()
     }
 }
 
+GLuint MirOpenGLContext::defaultFramebufferObject(QPlatformSurface *surface) const
+{
+    if (surface->surface()->surfaceClass() == QSurface::Offscreen) {
+        return QPlatformOpenGLContext::defaultFramebufferObject(surface);
+    }
+
+    // Scenes of rotated outputs get rendered into a framebuffer object, see OutputRotation
+    return static_cast<ScreenWindow*>(surface)->defaultFramebufferObject();
+}
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 7, 0)
 QFunctionPointer MirOpenGLContext::getProcAddress(const QByteArray &procName)
 {
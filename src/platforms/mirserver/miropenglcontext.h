@@ -41,6 +41,7 @@ public:
 
     bool makeCurrent(QPlatformSurface *surface) override;
     void doneCurrent() override;
+    GLuint defaultFramebufferObject(QPlatformSurface *surface) const override;
 
     bool isSharing() const override { return false; }
 
@@ -18,6 +18,7 @@
 
 #include "mirserverhooks.h"
 
+#include "hardwarecursor.h"
 #include "mircursorimages.h"
 #include "promptsessionlistener.h"
 #include "screenscontroller.h"
@@ -87,8 +88,13 @@ void qtmir::MirServerHooks::operator()(mir::Server& server)
     server.override_the_cursor_images([]
         { return std::make_shared<qtmir::MirCursorImages>(); });
 
-    server.wrap_cursor([&](std::shared_ptr<mg::Cursor> const& wrapped)
-        { return std::make_shared<HiddenCursorWrapper>(wrapped); });
+    server.wrap_cursor([&](std::shared_ptr<mg::Cursor> const& wrapped) -> std::shared_ptr<mg::Cursor>
+        {
+            if (qtmir::HardwareCursor::isEnabled())
+                return qtmir::HardwareCursor::create(wrapped);
+
+            return std::make_shared<HiddenCursorWrapper>(wrapped);
+        });
 
     server.override_the_prompt_session_listener([this]
         {
@@ -36,11 +36,13 @@
 
 // local
 #include "clipboard.h"
+#include "framebufferpool.h"
 #include "miropenglcontext.h"
 #include "nativeinterface.h"
 #include "offscreensurface.h"
 #include "qmirserver.h"
 #include "screen.h"
+#include "screencast.h"
 #include "screensmodel.h"
 #include "screenwindow.h"
 #include "services.h"
@@ -55,6 +57,7 @@ MirServerIntegration::MirServerIntegration()
     , m_fontDb(new QGenericUnixFontDatabase())
     , m_services(new Services)
     , m_mirServer(new QMirServer)
+    , m_framebufferPool(std::make_shared<FramebufferPool>())
     , m_nativeInterface(nullptr)
 {
     // For access to sensors, qtmir uses qtubuntu-sensors. qtubuntu-sensors reads the
@@ -80,6 +83,7 @@ MirServerIntegration::MirServerIntegration()
 
 MirServerIntegration::~MirServerIntegration()
 {
+    qDeleteAll(m_screencasts);
     delete m_nativeInterface;
 }
 
@@ -143,9 +147,10 @@ void MirServerIntegration::initialize()
         qFatal("ScreensModel not initialized");
     }
     QObject::connect(screens.data(), &ScreensModel::screenAdded,
-            [this](Screen *screen) { this->screenAdded(screen); });
+            [this](Screen *screen) { this->screenAdded(screen); startScreencast(screen); });
     QObject::connect(screens.data(), &ScreensModel::screenRemoved,
             [this](Screen *screen) {
+        stopScreencast(screen);
 #if QT_VERSION < QT_VERSION_CHECK(5, 5, 0)
         delete screen;
 #else
@@ -155,9 +160,44 @@ void MirServerIntegration::initialize()
 
     Q_FOREACH(auto screen, screens->screens()) {
         screenAdded(screen);
+        startScreencast(screen);
     }
 
-    m_nativeInterface = new NativeInterface(m_mirServer.data());
+    m_nativeInterface = new NativeInterface(m_mirServer.data(), m_framebufferPool);
+}
+
+void MirServerIntegration::startScreencast(Screen *screen)
+{
+    QString destination = QString::fromLocal8Bit(qgetenv("QTMIR_SCREENCAST"));
+    if (destination.isEmpty()) {
+        return;
+    }
+
+    if (destination.contains(QLatin1String("%1"))) {
+        destination = destination.arg(screen->outputId().as_value());
+    } else if (!m_screencasts.isEmpty()) {
+        qCWarning(QTMIR_SCREENS) << "Not recording" << screen << "as QTMIR_SCREENCAST has no %1 for the output id";
+        return;
+    }
+
+    QIODevice *output = Screencast::openOutput(destination);
+    if (!output) {
+        return;
+    }
+
+    bool ok;
+    int maxFramesPerSecond = qgetenv("QTMIR_SCREENCAST_FPS").toInt(&ok);
+    if (!ok || maxFramesPerSecond <= 0) {
+        maxFramesPerSecond = Screencast::defaultMaxFramesPerSecond;
+    }
+
+    qCDebug(QTMIR_SCREENS) << "Recording" << screen << "to" << destination << "at up to" << maxFramesPerSecond << "fps";
+    m_screencasts.insert(screen, new Screencast(screen, output, maxFramesPerSecond));
+}
+
+void MirServerIntegration::stopScreencast(Screen *screen)
+{
+    delete m_screencasts.take(screen);
 }
 
 QPlatformAccessibility *MirServerIntegration::accessibility() const
@@ -203,5 +243,5 @@ QPlatformClipboard *MirServerIntegration::clipboard() const
 QPlatformOffscreenSurface *MirServerIntegration::createPlatformOffscreenSurface(
         QOffscreenSurface *surface) const
 {
-    return new OffscreenSurface(surface);
+    return new OffscreenSurface(surface, m_framebufferPool);
 }
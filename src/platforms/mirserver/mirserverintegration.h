@@ -19,10 +19,16 @@
 
 // qt
 #include <qpa/qplatformintegration.h>
+#include <QHash>
 #include <QScopedPointer>
 
+#include <memory>
+
+class FramebufferPool;
 class NativeInterface;
 class QMirServer;
+class Screen;
+class Screencast;
 
 class MirServerIntegration : public QPlatformIntegration
 {
@@ -55,11 +61,17 @@ public:
     QPlatformOffscreenSurface *createPlatformOffscreenSurface(QOffscreenSurface *surface) const override;
 
 private:
+    void startScreencast(Screen *screen);
+    void stopScreencast(Screen *screen);
+
     QScopedPointer<QPlatformAccessibility> m_accessibility;
     QScopedPointer<QPlatformFontDatabase> m_fontDb;
     QScopedPointer<QPlatformServices> m_services;
 
     QScopedPointer<QMirServer> m_mirServer;
+    std::shared_ptr<FramebufferPool> m_framebufferPool;
+
+    QHash<Screen*, Screencast*> m_screencasts;
 
     NativeInterface *m_nativeInterface;
     QPlatformInputContext* m_inputContext;
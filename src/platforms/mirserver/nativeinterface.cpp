@@ -16,22 +16,46 @@
 
 #include "nativeinterface.h"
 
+#include "framebufferpool.h"
 #include "qmirserver.h"
 #include "screen.h"
 #include "windowcontrollerinterface.h"
 
 #include <QDebug>
+#include <QWindow>
 
-NativeInterface::NativeInterface(QMirServer *server)
+NativeInterface::NativeInterface(QMirServer *server, const std::shared_ptr<FramebufferPool> &framebufferPool)
     : m_qMirServer(server)
+    , m_framebufferPool(framebufferPool)
 {
 }
 
 void *NativeInterface::nativeResourceForIntegration(const QByteArray &resource)
 {
+    if (resource == "FramebufferPool") {
+        return m_framebufferPool.get();
+    }
     return m_qMirServer->nativeResourceForIntegration(resource);
 }
 
+void *NativeInterface::nativeResourceForWindow(const QByteArray &resource, QWindow *window)
+{
+    if (!window || !window->handle()) {
+        return nullptr;
+    }
+    auto s = static_cast<Screen*>(window->handle()->screen());
+    if (!s) {
+        return nullptr;
+    }
+
+    if (resource == "DirectScanout") {
+        return static_cast<qtmir::DirectScanoutInterface*>(s);
+    } else if (resource == "FrameCapture") {
+        return static_cast<qtmir::FrameCaptureInterface*>(s);
+    }
+    return nullptr;
+}
+
 // Changes to these properties are emitted via the UbuntuNativeInterface::windowPropertyChanged
 // signal fired via UbuntuScreen. Connect to this signal for these properties updates.
 QVariantMap NativeInterface::windowProperties(QPlatformWindow *window) const
@@ -61,6 +85,8 @@ QVariant NativeInterface::windowProperty(QPlatformWindow *window, const QString
         return s->scale();
     } else if (name == QStringLiteral("formFactor")) {
         return static_cast<int>(s->formFactor()); // naughty, should add enum to Qt's Type system
+    } else if (name == QStringLiteral("frameTiming")) {
+        return s->frameTiming().toVariantMap();
     } else {
         return QVariant();
     }
@@ -24,6 +24,7 @@
 #include <memory>
 
 // local
+class FramebufferPool;
 class QMirServer;
 
 // mir
@@ -34,9 +35,10 @@ class NativeInterface : public QPlatformNativeInterface
 {
     Q_OBJECT
 public:
-    NativeInterface(QMirServer *);
+    NativeInterface(QMirServer *, const std::shared_ptr<FramebufferPool> &framebufferPool);
 
     void *nativeResourceForIntegration(const QByteArray &resource) override;
+    void *nativeResourceForWindow(const QByteArray &resource, QWindow *window) override;
 
     QVariantMap windowProperties(QPlatformWindow *window) const override;
     QVariant windowProperty(QPlatformWindow *window, const QString &name) const override;
@@ -48,6 +50,7 @@ public:
 
 private:
     QMirServer *m_qMirServer;
+    std::shared_ptr<FramebufferPool> m_framebufferPool;
 };
 
 #endif // NATIVEINTEGRATION_H
@@ -15,16 +15,43 @@
  */
 
 #include "offscreensurface.h"
+#include "framebufferpool.h"
 
 //Qt
 #include <QOffscreenSurface>
 #include <QOpenGLFramebufferObject>
 
-OffscreenSurface::OffscreenSurface(QOffscreenSurface *offscreenSurface)
+namespace {
+
+QOpenGLFramebufferObjectFormat bufferFormat(const QSurfaceFormat &format)
+{
+    QOpenGLFramebufferObjectFormat bufferFormat;
+    if (format.stencilBufferSize() > 0) {
+        bufferFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    } else if (format.depthBufferSize() > 0) {
+        bufferFormat.setAttachment(QOpenGLFramebufferObject::Depth);
+    }
+    bufferFormat.setSamples(qMax(format.samples(), 0));
+    return bufferFormat;
+}
+
+} // namespace {
+
+OffscreenSurface::OffscreenSurface(QOffscreenSurface *offscreenSurface,
+                                   const std::shared_ptr<FramebufferPool> &framebufferPool)
     : QPlatformOffscreenSurface(offscreenSurface)
+    , m_framebufferPool(framebufferPool)
     , m_buffer(nullptr)
     , m_format(offscreenSurface->requestedFormat())
+    , m_bufferFormat(bufferFormat(m_format))
+{
+}
+
+OffscreenSurface::~OffscreenSurface()
 {
+    if (m_buffer) {
+        m_framebufferPool->release(m_buffer);
+    }
 }
 
 QSurfaceFormat OffscreenSurface::format() const
@@ -45,7 +72,22 @@ QOpenGLFramebufferObject* OffscreenSurface::buffer() const
     return m_buffer;
 }
 
-void OffscreenSurface::setBuffer(QOpenGLFramebufferObject *buffer)
+bool OffscreenSurface::bindBuffer()
 {
-    m_buffer = buffer;
+    const QSize size = offscreenSurface()->size();
+
+    // Framebuffer objects are bound to the GL context they were created in
+    if (m_buffer && (m_buffer->size() != size || !m_framebufferPool->fitsCurrentContext(m_buffer))) {
+        m_framebufferPool->release(m_buffer);
+        m_buffer = nullptr;
+    }
+
+    if (!m_buffer) {
+        m_buffer = m_framebufferPool->acquire(size, m_bufferFormat);
+        if (!m_buffer) {
+            return false;
+        }
+    }
+
+    return m_buffer->bind();
 }
@@ -18,26 +18,35 @@
 #define OFFSCREENSURFACE_H
 
 #include <qpa/qplatformoffscreensurface.h>
+#include <QOpenGLFramebufferObjectFormat>
 #include <QSurfaceFormat>
 #include <QSharedPointer>
 
+#include <memory>
+
+class FramebufferPool;
 class MirServer;
 class QOpenGLFramebufferObject;
 
 class OffscreenSurface : public QPlatformOffscreenSurface
 {
 public:
-    OffscreenSurface(QOffscreenSurface *offscreenSurface);
+    OffscreenSurface(QOffscreenSurface *offscreenSurface, const std::shared_ptr<FramebufferPool> &framebufferPool);
+    ~OffscreenSurface();
 
     QSurfaceFormat format() const override;
     bool isValid() const override;
 
     QOpenGLFramebufferObject* buffer() const;
-    void setBuffer(QOpenGLFramebufferObject *buffer);
+
+    // Binds a buffer of the surface's current size, taken from the pool. Needs a GL context current.
+    bool bindBuffer();
 
 private:
+    const std::shared_ptr<FramebufferPool> m_framebufferPool;
     QOpenGLFramebufferObject *m_buffer;
     QSurfaceFormat m_format;
+    const QOpenGLFramebufferObjectFormat m_bufferFormat; // honouring the depth, stencil and samples of m_format
 };
 
 #endif // OFFSCREENSURFACE_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "outputrotation.h"
+
+// Qt
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+namespace {
+
+const char *vertexShader =
+    "uniform highp mat4 matrix;\n"
+    "attribute highp vec2 position;\n"
+    "attribute highp vec2 texCoord;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    v_texCoord = texCoord;\n"
+    "    gl_Position = matrix * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+const char *fragmentShader =
+    "uniform sampler2D source;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(source, v_texCoord);\n"
+    "}\n";
+
+// Covers the whole viewport, however rotated by multiples of 90 degrees
+const GLfloat quad[] = {
+    // position   texCoord
+    -1.0f, -1.0f,  0.0f, 0.0f,
+     1.0f, -1.0f,  1.0f, 0.0f,
+    -1.0f,  1.0f,  0.0f, 1.0f,
+     1.0f,  1.0f,  1.0f, 1.0f,
+};
+
+bool isSideways(MirOrientation orientation)
+{
+    return orientation == mir_orientation_left || orientation == mir_orientation_right;
+}
+
+} // namespace {
+
+OutputRotation::OutputRotation()
+{
+}
+
+OutputRotation::~OutputRotation()
+{
+}
+
+GLuint OutputRotation::framebuffer(const QSize &sceneSize)
+{
+    if (!m_framebuffer || m_framebuffer->size() != sceneSize) {
+        m_framebuffer.reset(); // not to hold both at once
+        m_framebuffer.reset(new QOpenGLFramebufferObject(sceneSize, QOpenGLFramebufferObject::CombinedDepthStencil));
+    }
+    return m_framebuffer->handle();
+}
+
+void OutputRotation::draw(MirOrientation orientation, const QSize &outputSize)
+{
+    if (!m_framebuffer) {
+        return;
+    }
+
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    if (!m_program) {
+        m_program.reset(new QOpenGLShaderProgram);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+        m_program->bindAttributeLocation("position", 0);
+        m_program->bindAttributeLocation("texCoord", 1);
+        m_program->link();
+    }
+
+    // The scene graph keeps track of the GL state it set, leave it as we found it
+    GLint previousProgram = 0;
+    GLint previousArrayBuffer = 0;
+    GLint previousTexture = 0;
+    gl->glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    gl->glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+    gl->glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    const bool blend = gl->glIsEnabled(GL_BLEND);
+    const bool depthTest = gl->glIsEnabled(GL_DEPTH_TEST);
+    const bool scissorTest = gl->glIsEnabled(GL_SCISSOR_TEST);
+    const bool stencilTest = gl->glIsEnabled(GL_STENCIL_TEST);
+
+    // The output's own framebuffer, as the default one of the QOpenGLContext is ours
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl->glViewport(0, 0, outputSize.width(), outputSize.height());
+    gl->glDisable(GL_BLEND);
+    gl->glDisable(GL_DEPTH_TEST);
+    gl->glDisable(GL_SCISSOR_TEST);
+    gl->glDisable(GL_STENCIL_TEST);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Counter-clockwise, as the y axis points up
+    QMatrix4x4 matrix;
+    matrix.rotate(orientation, 0, 0, 1);
+
+    m_program->bind();
+    m_program->setUniformValue("matrix", matrix);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, m_framebuffer->texture());
+    m_program->setUniformValue("source", 0);
+
+    m_program->enableAttributeArray(0);
+    m_program->enableAttributeArray(1);
+    m_program->setAttributeArray(0, GL_FLOAT, quad, 2, 4 * sizeof(GLfloat));
+    m_program->setAttributeArray(1, GL_FLOAT, quad + 2, 2, 4 * sizeof(GLfloat));
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_program->disableAttributeArray(0);
+    m_program->disableAttributeArray(1);
+
+    gl->glUseProgram(previousProgram);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+    gl->glBindTexture(GL_TEXTURE_2D, previousTexture);
+    if (blend) gl->glEnable(GL_BLEND);
+    if (depthTest) gl->glEnable(GL_DEPTH_TEST);
+    if (scissorTest) gl->glEnable(GL_SCISSOR_TEST);
+    if (stencilTest) gl->glEnable(GL_STENCIL_TEST);
+}
+
+QSize OutputRotation::sceneSize(MirOrientation orientation, const QSize &outputSize)
+{
+    return isSideways(orientation) ? outputSize.transposed() : outputSize;
+}
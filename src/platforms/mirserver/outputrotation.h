@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTROTATION_H
+#define OUTPUTROTATION_H
+
+// Qt
+#include <QScopedPointer>
+#include <QSize>
+#include <QtGui/qopengl.h>
+
+// Mir
+#include <mir_toolkit/common.h>
+
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+
+/*
+ * OutputRotation shows the scene of a Screen on an output that isn't in its normal orientation.
+ *
+ * The DisplayBuffers of Mir 0.26 keep the output's native orientation and leave rotating to the
+ * compositor. Instead of the shell rotating its whole QML scene, Qt renders the scene upright into
+ * a framebuffer object of the Screen's (rotated) size, which then gets drawn rotated into the
+ * output's framebuffer, in a single pass, right before swapping.
+ *
+ * Orientations are counter-clockwise, as for Mir: with mir_orientation_left, the top of the scene
+ * is shown along the left edge of the output.
+ *
+ * Threading Note:
+ * Lives in the render thread of its Screen, and must be used with the GL context current.
+ */
+class OutputRotation
+{
+public:
+    OutputRotation();
+    ~OutputRotation();
+
+    // The framebuffer object for Qt to render the scene of the given size into, (re)created as needed
+    GLuint framebuffer(const QSize &sceneSize);
+
+    // Draws the scene rendered into the output's framebuffer, of the given native size
+    void draw(MirOrientation orientation, const QSize &outputSize);
+
+    // Size of the scene shown on an output of the given native size
+    static QSize sceneSize(MirOrientation orientation, const QSize &outputSize);
+
+private:
+    QScopedPointer<QOpenGLFramebufferObject> m_framebuffer;
+    QScopedPointer<QOpenGLShaderProgram> m_program;
+};
+
+#endif // OUTPUTROTATION_H
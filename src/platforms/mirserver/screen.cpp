@@ -16,23 +16,37 @@
 
 // local
 #include "screen.h"
+#include "capturering.h"
+#include "displaygroupscheduler.h"
+#include "framereadback.h"
 #include "logging.h"
 #include "nativeinterface.h"
+#include "outputrotation.h"
+#include "screenmirror.h"
+#include "tracepoints.h" // generated from tracepoints.tp
 
 // Mir
 #include "mir/geometry/size.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/display.h"
+#include "mir/graphics/renderable.h"
 #include <mir/graphics/display_configuration.h>
 #include <mir/renderer/gl/render_target.h>
 
 // Qt
 #include <QGuiApplication>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <QRunnable>
 #include <qpa/qwindowsysteminterface.h>
 #include <QThread>
 #include <QtMath>
 
+// std
+#include <chrono>
+#include <functional>
+
 // Qt sensors
 #include <QtSensors/QOrientationReading>
 #include <QtSensors/QOrientationSensor>
@@ -57,6 +71,27 @@ static mir::renderer::gl::RenderTarget *as_render_target(
     return render_target;
 }
 
+// A client buffer shown unscaled over the whole screen
+class ScanoutRenderable : public mir::graphics::Renderable
+{
+public:
+    ScanoutRenderable(const std::shared_ptr<mir::graphics::Buffer> &buffer, const QRect &screenGeometry)
+        : m_buffer(buffer)
+        , m_position(mg::Point{screenGeometry.x(), screenGeometry.y()}, m_buffer->size())
+    {}
+
+    ID id() const override { return m_buffer.get(); }
+    std::shared_ptr<mir::graphics::Buffer> buffer() const override { return m_buffer; }
+    mg::Rectangle screen_position() const override { return m_position; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4(); }
+    bool shaped() const override { return false; }
+
+private:
+    const std::shared_ptr<mir::graphics::Buffer> m_buffer;
+    const mg::Rectangle m_position;
+};
+
 enum QImage::Format qImageFormatFromMirPixelFormat(MirPixelFormat mirPixelFormat) {
     switch (mirPixelFormat) {
     case mir_pixel_format_abgr_8888:
@@ -121,6 +156,17 @@ QString displayTypeToString(qtmir::OutputTypes type)
         return QStringLiteral("Unknown");
     } //switch
 }
+
+// Runs on the render thread of a QQuickWindow, with its GL context current
+class RenderJob : public QRunnable
+{
+public:
+    explicit RenderJob(const std::function<void()> &function) : m_function(function) {}
+    void run() override { m_function(); }
+
+private:
+    const std::function<void()> m_function;
+};
 } // namespace {
 
 
@@ -145,14 +191,25 @@ Screen::Screen(const mir::graphics::DisplayConfigurationOutput &screen)
     , m_refreshRate(-1.0)
     , m_scale(1.0)
     , m_formFactor(mir_form_factor_unknown)
+    , m_outputOrientation(mir_orientation_normal)
+    , m_displayBuffer(nullptr)
+    , m_displayBufferGeneration(0)
     , m_renderTarget(nullptr)
-    , m_displayGroup(nullptr)
     , m_orientationSensor(new QOrientationSensor(this))
+    , m_scanoutCommitted(false)
+    , m_scanningOut(false)
+    , m_nextCaptureId(1)
+    , m_captureRing(std::make_shared<CaptureRing>())
+    , m_mirrorSource(nullptr)
+    , m_drawingOutput(false)
     , m_screenWindow(nullptr)
     , m_unityScreen(nullptr)
 {
     setMirDisplayConfiguration(screen, false);
 
+    m_readbackPollTimer.setSingleShot(true);
+    QObject::connect(&m_readbackPollTimer, &QTimer::timeout, this, &Screen::pollFrameReadback);
+
     // Set the default orientation based on the initial screen dimmensions.
     m_nativeOrientation = (m_geometry.width() >= m_geometry.height())
         ? Qt::LandscapeOrientation : Qt::PortraitOrientation;
@@ -187,6 +244,21 @@ Screen::Screen(const mir::graphics::DisplayConfigurationOutput &screen)
 
 Screen::~Screen()
 {
+    // Neither mirrors of this Screen nor its source may draw or post into it anymore
+    setMirrorSource(nullptr);
+    QList<Screen*> mirrors;
+    {
+        QMutexLocker locker(&m_mirrorMutex);
+        mirrors = m_mirrors;
+    }
+    Q_FOREACH (Screen *mirror, mirrors) {
+        mirror->setMirrorSource(nullptr);
+    }
+
+    if (m_displayGroupScheduler) {
+        m_displayGroupScheduler->removeScreen(this);
+    }
+
     //if a ScreenWindow associated with this screen, kill it
     if (m_screenWindow) {
         m_screenWindow->window()->destroy(); // ends up destroying m_ScreenWindow
@@ -215,9 +287,14 @@ void Screen::setMirDisplayConfiguration(const mir::graphics::DisplayConfiguratio
     m_outputId = screen.id;
     m_type = static_cast<qtmir::OutputTypes>(screen.type); //FIXME: need compile time check these are equivalent
 
+    // Output orientation, applied when swapping. Everything else about the Screen is logical, as
+    // Mir's view area is: sideways outputs get their width and height swapped.
+    m_outputOrientation = screen.orientation;
+
     // Physical screen size
-    m_physicalSize.setWidth(screen.physical_size_mm.width.as_int());
-    m_physicalSize.setHeight(screen.physical_size_mm.height.as_int());
+    m_physicalSize = OutputRotation::sceneSize(m_outputOrientation,
+                                               QSize(screen.physical_size_mm.width.as_int(),
+                                                     screen.physical_size_mm.height.as_int()));
 
     // Screen capabilities
     m_currentModeIndex = screen.current_mode_index;
@@ -236,8 +313,8 @@ void Screen::setMirDisplayConfiguration(const mir::graphics::DisplayConfiguratio
 
     // Mode = current resolution & refresh rate
     mir::graphics::DisplayConfigurationMode mode = screen.modes.at(m_currentModeIndex);
-    m_geometry.setWidth(mode.size.width.as_int());
-    m_geometry.setHeight(mode.size.height.as_int());
+    m_geometry.setSize(OutputRotation::sceneSize(m_outputOrientation,
+                                                 QSize(mode.size.width.as_int(), mode.size.height.as_int())));
 
     // DPI - unnecessary to calculate, default implementation in QPlatformScreen is sufficient
 
@@ -254,6 +331,7 @@ void Screen::setMirDisplayConfiguration(const mir::graphics::DisplayConfiguratio
     // Refresh rate
     if (m_refreshRate != mode.vrefresh_hz) {
         m_refreshRate = mode.vrefresh_hz;
+        m_frameClock.setRefreshRate(m_refreshRate);
         if (notify) {
             QWindowSystemInterface::handleScreenRefreshRateChange(this->screen(), mode.vrefresh_hz);
         }
@@ -375,30 +453,424 @@ void Screen::setWindow(ScreenWindow *window)
     }
 }
 
-void Screen::setMirDisplayBuffer(mir::graphics::DisplayBuffer *buffer, mir::graphics::DisplaySyncGroup *group)
+void Screen::setMirDisplayBuffer(mir::graphics::DisplayBuffer *buffer,
+                                 const QSharedPointer<DisplayGroupScheduler> &scheduler)
 {
-    qCDebug(QTMIR_SCREENS) << "Screen::setMirDisplayBuffer" << this << as_render_target(buffer) << group;
+    qCDebug(QTMIR_SCREENS) << "Screen::setMirDisplayBuffer" << this << as_render_target(buffer) << scheduler->group();
     // This operation should only be performed while rendering is stopped
+    m_displayBuffer = buffer;
+    // Shared by all Screens, so that a window moved to another Screen can't mistake its buffer for the old one
+    static quint64 lastDisplayBufferGeneration = 0;
+    m_displayBufferGeneration = ++lastDisplayBufferGeneration;
     m_renderTarget = as_render_target(buffer);
-    m_displayGroup = group;
+    m_scanoutBuffer.reset();
+    m_scannedOutBuffer.reset();
+    m_scanoutCommitted = false;
+    m_scanningOut = false;
+
+    if (m_displayGroupScheduler != scheduler) {
+        if (m_displayGroupScheduler) {
+            m_displayGroupScheduler->removeScreen(this);
+        }
+        m_displayGroupScheduler = scheduler;
+        m_displayGroupScheduler->addScreen(this, m_screenWindow && m_screenWindow->isExposed());
+    }
+}
+
+void Screen::setRendering(bool rendering)
+{
+    if (m_displayGroupScheduler) {
+        m_displayGroupScheduler->setScreenRendering(this, rendering);
+    }
+}
+
+// Called from the render thread, as Qt starts rendering a frame of the scene
+void Screen::frameStarted()
+{
+    if (m_displayGroupScheduler) {
+        m_displayGroupScheduler->frameStarted(this);
+    }
+}
+
+void Screen::setMirrorSource(Screen *source)
+{
+    Screen *const previousSource = m_mirrorSource;
+    if (source == previousSource) {
+        return;
+    }
+
+    qCDebug(QTMIR_SCREENS) << "Screen::setMirrorSource" << this << "mirrors" << source;
+
+    if (previousSource) {
+        {
+            // Out of the list, the render thread of the source leaves this Screen alone
+            QMutexLocker locker(&previousSource->m_mirrorMutex);
+            previousSource->m_mirrors.removeAll(this);
+        }
+        m_mirrorFramePoster.reset(); // posts the frame still pending, if any
+        setRendering(false);
+    }
+
+    m_mirrorSource = source;
+
+    if (source) {
+        // Screens posted together with this one should wait for the frames drawn into it
+        setRendering(true);
+        m_mirrorFramePoster.reset(new MirrorFramePoster(this));
+        {
+            QMutexLocker locker(&source->m_mirrorMutex);
+            source->m_mirrors.append(this);
+        }
+        source->requestFrame();
+    }
+}
+
+// Called from the render thread, before the frame gets rendered
+bool Screen::offerScanoutBuffer(const std::shared_ptr<mir::graphics::Buffer> &buffer,
+                                const std::shared_ptr<mir::graphics::Buffer> &previousBuffer)
+{
+    m_scanoutBuffer = buffer;
+
+    // Only once the display has shown it can scan out the buffers of the item offering them, rather
+    // than those of another one it replaces, does it commit to this one. swapBuffers() then keeps to
+    // that, as the frame gets rendered without the buffer.
+    m_scanoutCommitted = previousBuffer && m_scannedOutBuffer.lock() == previousBuffer && fitsScanout(buffer);
+    if (m_scanoutCommitted) {
+        // What gets captured is what Qt rendered, so no scanning out while capturing
+        QMutexLocker locker(&m_captureMutex);
+        m_scanoutCommitted = m_frameCaptures.isEmpty() && m_nextFrameHandlers.isEmpty();
+    }
+    if (m_scanoutCommitted) {
+        // Same goes for what mirrors show
+        QMutexLocker locker(&m_mirrorMutex);
+        m_scanoutCommitted = m_mirrors.isEmpty();
+    }
+    return m_scanoutCommitted;
+}
+
+// Whether the buffer can stand for the whole output, as far as the Screen is concerned
+bool Screen::fitsScanout(const std::shared_ptr<mir::graphics::Buffer> &buffer) const
+{
+    // Client buffers are upright, rotated outputs need the final pass
+    return buffer && m_outputOrientation == mir_orientation_normal
+            && buffer->size() == mg::Size{m_geometry.width(), m_geometry.height()};
 }
 
 void Screen::swapBuffers()
 {
+    // If the scene graph offered a client buffer covering the whole screen, let the display scan it
+    // out directly if it can. The frame Qt rendered is then dropped instead of being swapped in.
+    const auto scanoutBuffer = std::move(m_scanoutBuffer);
+    m_scanoutBuffer.reset();
+
+    // The buffer was left out of the frame, as the display committed to scanning it out
+    const bool committed = m_scanoutCommitted;
+    m_scanoutCommitted = false;
+
+    // What gets captured is what Qt rendered, so no scanning out while capturing, unless committed
+    // to it already. Captures that came along since then get the next frame.
+    const bool capturing = captureFrame(committed);
+
+    // Same goes for what mirrors show
+    QMutexLocker mirrorLocker(&m_mirrorMutex);
+    const bool mirrored = !m_mirrors.isEmpty();
+
+    const bool rotated = m_outputOrientation != mir_orientation_normal;
+
+    // From here on, "0" is the output's own framebuffer again, not the one the scene got rendered into
+    m_drawingOutput = true;
+
+    bool scannedOut = false;
+    if ((committed || (!capturing && !mirrored)) && fitsScanout(scanoutBuffer)) {
+        scannedOut = m_displayBuffer->overlay({std::make_shared<ScanoutRenderable>(scanoutBuffer, m_geometry)});
+    }
+
+    if (committed && !scannedOut) {
+        // Rather than showing a frame lacking the buffer, leave what the display shows alone and
+        // have the frame rendered again, with nothing left out of it
+        qCDebug(QTMIR_SCREENS) << "Screen::swapBuffers -" << this << "display declined the buffer it"
+                               << "committed to scanning out, rendering the frame again";
+        m_scannedOutBuffer.reset();
+        m_scanningOut = false;
+        mirrorLocker.unlock();
+        m_drawingOutput = false;
+        m_displayGroupScheduler->frameDropped(this);
+        requestFrame();
+        return;
+    }
+
+    if (scannedOut) {
+        m_scannedOutBuffer = scanoutBuffer;
+    } else {
+        m_scannedOutBuffer.reset();
+    }
+
+    if (scannedOut != m_scanningOut) {
+        qCDebug(QTMIR_SCREENS) << "Screen::swapBuffers -" << this << (scannedOut ? "started" : "stopped")
+                               << "scanning out a client buffer directly";
+        m_scanningOut = scannedOut;
+    }
+
+    if (mirrored && committed) {
+        requestFrame(); // which the display won't commit to scanning out, for the mirrors to get it
+    } else if (mirrored) {
+        presentToMirrors();
+    } else {
+        m_screenMirror.reset();
+    }
+    mirrorLocker.unlock();
+
+    m_frameTiming.swapStarted(FrameTiming::now());
+    if (scannedOut) {
+        tracepoint(qtmirserver, screenScannedOut, m_outputId.as_value());
+    } else {
+        if (rotated && m_outputRotation) {
+            m_outputRotation->draw(m_outputOrientation, outputSize());
+        }
+        m_renderTarget->swap_buffers();
+    }
+    m_frameTiming.swapFinished(FrameTiming::now());
+    tracepoint(qtmirserver, screenSwapped, m_outputId.as_value());
+
+    if (!rotated) {
+        m_outputRotation.reset();
+    }
+    m_drawingOutput = false;
+
+    postFrame();
+}
+
+// Called from the render thread, or from the poster thread of a mirror, once the frame got swapped
+void Screen::postFrame()
+{
+    // A DisplaySyncGroup can hold several DisplayBuffers, and posting it submits all of them for
+    // flipping. So rather than posting it from each Screen's render thread, let the scheduler post
+    // it once all the Screens of the group have rendered their frame. Blocks until then.
+    m_displayGroupScheduler->frameSwapped(this);
+
+    const qint64 postedTime = FrameTiming::now();
+    const FrameTiming::Frame frame = m_frameTiming.framePosted(postedTime, m_frameClock.period());
+    tracepoint(qtmirserver, screenFrameTiming, m_outputId.as_value(),
+               frame.durations[FrameTiming::Sync], frame.durations[FrameTiming::Render],
+               frame.durations[FrameTiming::Swap], frame.durations[FrameTiming::VsyncWait],
+               frame.missedVsyncs);
+
+    if (frame.unblankLatency >= 0) {
+        qCDebug(QTMIR_SCREENS) << "Screen::swapBuffers -" << this << "first frame after exposure took"
+                               << frame.unblankLatency / 1000 << "us," << (m_frameTiming.lastUnblankWarm() ? "warm" : "cold");
+        tracepoint(qtmirserver, screenUnblanked, m_outputId.as_value(), frame.unblankLatency,
+                   m_frameTiming.lastUnblankWarm());
+    }
+
+    m_frameClock.framePosted(postedTime);
+
+    // Reads back are collected with the next frame. Rather than forcing one, have them polled for
+    // should none come within a refresh period.
+    if (m_frameReadback && m_frameReadback->hasReadsInFlight()) {
+        scheduleFrameReadbackPoll();
+    }
+}
+
+// Can be called from any thread. Restarts the countdown for every frame posted.
+void Screen::scheduleFrameReadbackPoll()
+{
+    const int interval = qMax<qint64>(1, m_frameClock.period() / 1000000);
+    QMetaObject::invokeMethod(&m_readbackPollTimer, "start", Qt::QueuedConnection, Q_ARG(int, interval));
+}
+
+// Called from the GUI thread, once no frame came to collect reads back
+void Screen::pollFrameReadback()
+{
+    // What a mirror shows gets rendered, and read back, by the render thread of its source
+    Screen *renderingScreen = m_mirrorSource ? m_mirrorSource.load() : this;
+    auto window = renderingScreen->m_screenWindow
+            ? qobject_cast<QQuickWindow*>(renderingScreen->m_screenWindow->window()) : nullptr;
+
+    // Jobs for windows not exposed get dropped. Their reads are left for their next frame.
+    if (window && window->isExposed()) {
+        window->scheduleRenderJob(new RenderJob([this]() { collectFrameReadback(); }), QQuickWindow::NoStage);
+    }
+}
+
+// Called from the render thread by the job pollFrameReadback() schedules, in between frames.
+// Jobs get run before the window goes away, so before this Screen does.
+void Screen::collectFrameReadback()
+{
+    if (!m_frameReadback) {
+        return;
+    }
+
+    // Mirrors read back in their own context, the source's is current for the job
+    Screen *source = m_mirrorSource;
+    if (source) {
+        if (!m_renderTarget) {
+            return;
+        }
+        makeCurrent();
+    }
+    const bool readsInFlight = m_frameReadback->collect();
+    if (source) {
+        source->makeCurrent();
+    }
+
+    if (readsInFlight) {
+        scheduleFrameReadbackPoll();
+    }
+}
+
+// Called from the render thread, with m_mirrorMutex locked and the frame rendered but not swapped yet
+void Screen::presentToMirrors()
+{
+    QList<Screen*> mirrors;
+    bool skipped = false;
+    Q_FOREACH (Screen *mirror, m_mirrors) {
+        // A mirror still posting its previous frame is waiting for its own vsync. It gets the next one.
+        if (mirror->m_renderTarget && mirror->m_mirrorFramePoster->isIdle()) {
+            mirrors.append(mirror);
+        } else {
+            skipped = true;
+        }
+    }
+
+    if (!mirrors.isEmpty()) {
+        if (!m_screenMirror) {
+            m_screenMirror.reset(new ScreenMirror);
+        }
+        m_screenMirror->copyFrame(m_geometry.size());
+
+        Q_FOREACH (Screen *mirror, mirrors) {
+            mirror->frameStarted();
+            mirror->makeCurrent();
+            m_screenMirror->drawFrame(mirror->outputSize()); // mirrors aren't rotated
+            mirror->swapMirroredFrame();
+        }
+        makeCurrent();
+
+        tracepoint(qtmirserver, screenMirrored, m_outputId.as_value(), mirrors.count());
+    }
+
+    // Else the mirrors skipped keep showing a stale frame until the scene changes
+    if (skipped) {
+        requestFrame();
+    }
+}
+
+// Called from the render thread of the source, with the frame drawn into this mirror
+void Screen::swapMirroredFrame()
+{
+    captureFrame();
+
+    m_frameTiming.swapStarted(FrameTiming::now());
     m_renderTarget->swap_buffers();
+    m_frameTiming.swapFinished(FrameTiming::now());
+    tracepoint(qtmirserver, screenSwapped, m_outputId.as_value());
+
+    m_mirrorFramePoster->post();
+}
 
-    /* FIXME this exposes a QtMir architecture problem, as Screen is supposed to wrap a mg::DisplayBuffer.
-     * We use Qt's multithreaded renderer, where each Screen is rendered to relatively independently, and
-     * post() called also individually.
-     *
-     * But if this is a native server on Android, in the multimonitor case a DisplaySyncGroup can contain
-     * 2+ DisplayBuffers, one post() call will submit all mg::DisplayBuffers in the group for flipping.
-     * This will cause just one Screen to be updated, blocking the swap call for the other Screens, which
-     * will slow rendering dramatically.
-     *
-     * Integrating the Qt Scenegraph renderer as a Mir renderer should solve this issue.
-     */
-    m_displayGroup->post();
+void Screen::captureNextFrame(const qtmir::FrameHandler &handler)
+{
+    {
+        QMutexLocker locker(&m_captureMutex);
+        m_nextFrameHandlers.append(handler);
+    }
+    requestFrame();
+}
+
+int Screen::startCapturing(const qtmir::FrameHandler &handler, int maxFramesPerSecond)
+{
+    const qint64 minimumInterval = maxFramesPerSecond > 0 ? 1000000000 / maxFramesPerSecond : 0;
+
+    int id;
+    {
+        QMutexLocker locker(&m_captureMutex);
+        id = m_nextCaptureId++;
+        m_frameCaptures.insert(id, FrameCapture{handler, minimumInterval, 0});
+    }
+    requestFrame();
+    return id;
+}
+
+void Screen::stopCapturing(int id)
+{
+    QMutexLocker locker(&m_captureMutex);
+    m_frameCaptures.remove(id);
+}
+
+// Called from the render thread, with the frame rendered but not swapped yet.
+// Returns whether any frame capture is pending.
+// Called from the render thread. Frames incomplete, as the scene graph left out what the display
+// scans out, are not captured. The next frame, which nothing gets left out of, will be.
+bool Screen::captureFrame(bool incomplete)
+{
+    if (m_frameReadback) {
+        m_frameReadback->collect();
+    }
+
+    const qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    bool capturing;
+    QList<qtmir::FrameHandler> handlers;
+    QList<qtmir::FrameHandler> nextFrameHandlers;
+    {
+        QMutexLocker locker(&m_captureMutex);
+        for (auto it = m_frameCaptures.begin(); it != m_frameCaptures.end(); ++it) {
+            if (now - it->lastCaptureTime >= it->minimumInterval) {
+                it->lastCaptureTime = now;
+                handlers.append(it->handler);
+            }
+        }
+        nextFrameHandlers.swap(m_nextFrameHandlers);
+        capturing = !m_frameCaptures.isEmpty() || !nextFrameHandlers.isEmpty();
+    }
+    handlers += nextFrameHandlers;
+
+    if (handlers.isEmpty()) {
+        if (capturing) {
+            return true;
+        }
+        if (m_frameReadback && !m_frameReadback->hasReadsInFlight()) {
+            m_frameReadback.reset();
+        }
+        return false;
+    }
+
+    bool read = false;
+    if (!incomplete) {
+        if (!m_frameReadback) {
+            m_frameReadback.reset(new FrameReadback(m_captureRing));
+        }
+        read = m_frameReadback->read(m_geometry.size(), QImage::Format_RGBX8888, true /* bottomUp */,
+            [handlers](const std::shared_ptr<const qtmir::CapturedFrame> &frame) {
+                Q_FOREACH (const qtmir::FrameHandler &handler, handlers) {
+                    handler(frame);
+                }
+            });
+    }
+
+    if (!read && !nextFrameHandlers.isEmpty()) {
+        QMutexLocker locker(&m_captureMutex);
+        m_nextFrameHandlers = nextFrameHandlers + m_nextFrameHandlers;
+        requestFrame();
+    }
+
+    return true;
+}
+
+// Can be called from any thread
+void Screen::requestFrame()
+{
+    // What a mirror shows gets rendered for its source
+    if (Screen *source = m_mirrorSource) {
+        source->requestFrame();
+        return;
+    }
+
+    if (m_screenWindow) {
+        // QQuickWindow::update()
+        QMetaObject::invokeMethod(m_screenWindow->window(), "update", Qt::QueuedConnection);
+    }
 }
 
 void Screen::makeCurrent()
@@ -411,6 +883,26 @@ void Screen::doneCurrent()
     m_renderTarget->release_current();
 }
 
+// The framebuffer Qt renders the scene into, which is the output's own unless it is rotated
+GLuint Screen::renderFramebuffer()
+{
+    if (m_outputOrientation == mir_orientation_normal || m_drawingOutput) {
+        return 0;
+    }
+
+    if (!m_outputRotation) {
+        m_outputRotation.reset(new OutputRotation);
+    }
+    return m_outputRotation->framebuffer(m_geometry.size());
+}
+
+// Native size of the output, as its DisplayBuffer has it
+QSize Screen::outputSize() const
+{
+    // Swapping width and height back and forth is the same
+    return OutputRotation::sceneSize(m_outputOrientation, m_geometry.size());
+}
+
 bool Screen::internalDisplay() const
 {
     using namespace mir::graphics;
@@ -18,27 +18,46 @@
 #define SCREEN_H
 
 // Qt
+#include <QList>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <QTimer>
 #include <QtDBus/QDBusInterface>
+#include <QtGui/qopengl.h>
 #include <qpa/qplatformscreen.h>
 
+// std
+#include <atomic>
+
 // Mir
 #include <mir_toolkit/common.h>
 
 // local
 #include "cursor.h"
+#include "directscanoutinterface.h"
+#include "framecaptureinterface.h"
+#include "frameclock.h"
+#include "frametiming.h"
 #include "screenwindow.h"
 #include "screentypes.h"
 
+class CaptureRing;
+class DisplayGroupScheduler;
+class FrameReadback;
+class MirrorFramePoster;
+class OutputRotation;
 class QOrientationSensor;
+class ScreenMirror;
 namespace mir {
-    namespace graphics { class DisplayBuffer; class DisplaySyncGroup; class DisplayConfigurationOutput; }
+    namespace graphics { class Buffer; class DisplayBuffer; class DisplayConfigurationOutput; }
     namespace renderer { namespace gl { class RenderTarget; }}
 }
 
-class Screen : public QObject, public QPlatformScreen
+class Screen : public QObject, public QPlatformScreen, public qtmir::DirectScanoutInterface,
+        public qtmir::FrameCaptureInterface
 {
     Q_OBJECT
 public:
@@ -63,12 +82,32 @@ public:
     qtmir::OutputId outputId() const { return m_outputId; }
     qtmir::OutputTypes outputType() const { return m_type; }
     uint32_t currentModeIndex() const { return m_currentModeIndex; }
+    MirOrientation outputOrientation() const { return m_outputOrientation; }
 
     ScreenWindow* window() const;
 
+    // Render thread marks are set by ScreenWindow and swapBuffers()
+    FrameTiming &frameTiming() { return m_frameTiming; }
+    const FrameTiming &frameTiming() const { return m_frameTiming; }
+
+    // Paces the render thread at this screen's own refresh rate
+    const FrameClock &frameClock() const { return m_frameClock; }
+
+    // The Screen whose frames this one shows, scaled to fit, instead of rendering its own
+    Screen *mirrorSource() const { return m_mirrorSource; }
+
     // QObject methods.
     void customEvent(QEvent* event) override;
 
+    // DirectScanoutInterface methods.
+    bool offerScanoutBuffer(const std::shared_ptr<mir::graphics::Buffer> &buffer,
+                            const std::shared_ptr<mir::graphics::Buffer> &previousBuffer) override;
+
+    // FrameCaptureInterface methods.
+    void captureNextFrame(const qtmir::FrameHandler &handler) override;
+    int startCapturing(const qtmir::FrameHandler &handler, int maxFramesPerSecond = 0) override;
+    void stopCapturing(int id) override;
+
     // To make it testable
     static bool skipDBusRegistration;
     bool orientationSensorEnabled();
@@ -81,16 +120,30 @@ protected:
     void setWindow(ScreenWindow *window);
 
     void setMirDisplayConfiguration(const mir::graphics::DisplayConfigurationOutput &, bool notify = true);
-    void setMirDisplayBuffer(mir::graphics::DisplayBuffer *, mir::graphics::DisplaySyncGroup *);
+    void setMirDisplayBuffer(mir::graphics::DisplayBuffer *, const QSharedPointer<DisplayGroupScheduler> &);
+    void setRendering(bool rendering);
+    void frameStarted();
+    void setMirrorSource(Screen *source);
     void swapBuffers();
     void makeCurrent();
     void doneCurrent();
+    GLuint renderFramebuffer();
 
 private:
     void toggleSensors(const bool enable) const;
     bool internalDisplay() const;
-
-    QRect m_geometry;
+    bool captureFrame(bool incomplete);
+    bool fitsScanout(const std::shared_ptr<mir::graphics::Buffer> &buffer) const;
+    void requestFrame();
+    void presentToMirrors();
+    void swapMirroredFrame();
+    void postFrame();
+    void scheduleFrameReadbackPoll();
+    void pollFrameReadback();
+    void collectFrameReadback();
+    QSize outputSize() const;
+
+    QRect m_geometry; // logical, so rotated along with the output
     int m_depth;
     QImage::Format m_format;
     qreal m_devicePixelRatio;
@@ -99,9 +152,12 @@ private:
     float m_scale;
     MirFormFactor m_formFactor;
     uint32_t m_currentModeIndex;
+    MirOrientation m_outputOrientation;
 
+    mir::graphics::DisplayBuffer *m_displayBuffer;
+    quint64 m_displayBufferGeneration; // unique to each setMirDisplayBuffer() call, 0 before the first
     mir::renderer::gl::RenderTarget *m_renderTarget;
-    mir::graphics::DisplaySyncGroup *m_displayGroup;
+    QSharedPointer<DisplayGroupScheduler> m_displayGroupScheduler;
     qtmir::OutputId m_outputId;
     qtmir::OutputTypes m_type;
     MirPowerMode m_powerMode;
@@ -110,11 +166,49 @@ private:
     Qt::ScreenOrientation m_currentOrientation;
     QOrientationSensor *m_orientationSensor;
 
+    // Only touched by the render thread
+    std::shared_ptr<mir::graphics::Buffer> m_scanoutBuffer;
+    std::weak_ptr<mir::graphics::Buffer> m_scannedOutBuffer;
+    bool m_scanoutCommitted; // the scene graph left m_scanoutBuffer out of the frame
+    bool m_scanningOut;
+    QScopedPointer<FrameReadback> m_frameReadback;
+
+    // Has the render thread collect reads back in between frames, should none come for a while
+    QTimer m_readbackPollTimer;
+
+    QMutex m_captureMutex;
+    QList<qtmir::FrameHandler> m_nextFrameHandlers; // guarded by m_captureMutex
+    struct FrameCapture {
+        qtmir::FrameHandler handler;
+        qint64 minimumInterval; // ns
+        qint64 lastCaptureTime;
+    };
+    QMap<int, FrameCapture> m_frameCaptures; // guarded by m_captureMutex
+    int m_nextCaptureId;
+    const std::shared_ptr<CaptureRing> m_captureRing;
+
+    FrameTiming m_frameTiming;
+    FrameClock m_frameClock;
+
+    // Clone mode. A mirror gets its frames drawn in by the render thread of its source, which
+    // only draws into the mirrors listed while holding m_mirrorMutex.
+    std::atomic<Screen*> m_mirrorSource;
+    QScopedPointer<MirrorFramePoster> m_mirrorFramePoster; // while mirroring
+    QMutex m_mirrorMutex;
+    QList<Screen*> m_mirrors; // guarded by m_mirrorMutex
+    QScopedPointer<ScreenMirror> m_screenMirror; // only touched by the render thread
+
+    // Rotated outputs get the scene rendered into a framebuffer object, drawn rotated into the
+    // output's own framebuffer when swapping. Only touched by the render thread.
+    QScopedPointer<OutputRotation> m_outputRotation;
+    bool m_drawingOutput;
+
     ScreenWindow *m_screenWindow;
     QDBusInterface *m_unityScreen;
 
     QScopedPointer<qtmir::Cursor> m_cursor;
 
+    friend class MirrorFramePoster;
     friend class ScreensModel;
     friend class ScreenWindow;
 };
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screencast.h"
+#include "logging.h"
+#include "tracepoints.h" // generated from tracepoints.tp
+
+// Qt
+#include <QDataStream>
+#include <QFile>
+#include <QMutexLocker>
+
+// local system
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace qtmir;
+
+namespace {
+
+// Writes to a connected socket. Unlike with a QFile, the process doesn't get a SIGPIPE if the
+// other end goes away, the write just fails.
+class SocketOutput : public QIODevice
+{
+public:
+    explicit SocketOutput(int fd) : m_fd(fd) { open(QIODevice::WriteOnly | QIODevice::Unbuffered); }
+    ~SocketOutput() { close(); ::close(m_fd); }
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+
+    qint64 writeData(const char *data, qint64 length) override
+    {
+        qint64 written = 0;
+        while (written < length) {
+            const ssize_t result = send(m_fd, data + written, length - written, MSG_NOSIGNAL);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            written += result;
+        }
+        return written;
+    }
+
+private:
+    const int m_fd;
+};
+
+} // namespace {
+
+Screencast::Screencast(FrameCaptureInterface *frameCapture, QIODevice *output, int maxFramesPerSecond)
+    : m_frameCapture(frameCapture)
+    , m_pendingFrame(std::make_shared<PendingFrame>())
+    , m_output(output)
+    , m_capturing(true)
+{
+    start(QThread::LowPriority);
+
+    // Called from the render thread
+    const std::shared_ptr<PendingFrame> pendingFrame = m_pendingFrame;
+    m_captureId = m_frameCapture->startCapturing([pendingFrame](const std::shared_ptr<const CapturedFrame> &frame) {
+        if (!frame) {
+            return;
+        }
+        QMutexLocker locker(&pendingFrame->mutex);
+        if (pendingFrame->stopping) {
+            return;
+        }
+        if (pendingFrame->frame) {
+            ++pendingFrame->droppedCount;
+        }
+        pendingFrame->frame = frame;
+        pendingFrame->available.wakeOne();
+    }, maxFramesPerSecond);
+}
+
+Screencast::~Screencast()
+{
+    stopCapturing();
+
+    {
+        QMutexLocker locker(&m_pendingFrame->mutex);
+        m_pendingFrame->stopping = true;
+        m_pendingFrame->available.wakeOne();
+    }
+    wait();
+
+    qCDebug(QTMIR_SCREENS) << "Screencast: frames=" << m_encoder.encodedFrameCount()
+                           << "tiles=" << m_encoder.encodedTileCount() << "dropped=" << droppedFrameCount();
+}
+
+QIODevice *Screencast::openOutput(const QString &destination)
+{
+    if (!destination.startsWith(QLatin1String("unix:"))) {
+        QScopedPointer<QFile> file(new QFile(destination));
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCWarning(QTMIR_SCREENS) << "Screencast: failed to open" << destination << "-" << file->errorString();
+            return nullptr;
+        }
+        return file.take();
+    }
+
+    const QByteArray path = QFile::encodeName(destination.mid(5));
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.isEmpty() || path.size() >= (int)sizeof(address.sun_path)) {
+        qCWarning(QTMIR_SCREENS) << "Screencast: invalid socket path" << destination;
+        return nullptr;
+    }
+    memcpy(address.sun_path, path.constData(), path.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        qCWarning(QTMIR_SCREENS) << "Screencast: failed to connect to" << destination << "-" << strerror(errno);
+        ::close(fd);
+        return nullptr;
+    }
+    return new SocketOutput(fd);
+}
+
+quint64 Screencast::droppedFrameCount() const
+{
+    QMutexLocker locker(&m_pendingFrame->mutex);
+    return m_pendingFrame->droppedCount;
+}
+
+void Screencast::stopCapturing()
+{
+    if (m_capturing) {
+        m_frameCapture->stopCapturing(m_captureId);
+        m_capturing = false;
+    }
+}
+
+void Screencast::run()
+{
+    QDataStream out(m_output.data());
+    m_encoder.writeHeader(out);
+
+    Q_FOREVER {
+        std::shared_ptr<const CapturedFrame> frame;
+        {
+            QMutexLocker locker(&m_pendingFrame->mutex);
+            while (!m_pendingFrame->frame && !m_pendingFrame->stopping) {
+                m_pendingFrame->available.wait(&m_pendingFrame->mutex);
+            }
+            if (!m_pendingFrame->frame) {
+                break;
+            }
+            frame.swap(m_pendingFrame->frame);
+        }
+
+        const quint64 tilesBefore = m_encoder.encodedTileCount();
+        if (m_encoder.encode(*frame, out)) {
+            tracepoint(qtmirserver, screencastFrameEncoded, m_encoder.encodedTileCount() - tilesBefore);
+        }
+        frame.reset(); // back to the capture ring
+
+        if (out.status() != QDataStream::Ok) {
+            qCWarning(QTMIR_SCREENS) << "Screencast: failed to write, stopping -" << m_output->errorString();
+            {
+                QMutexLocker locker(&m_pendingFrame->mutex);
+                m_pendingFrame->stopping = true;
+                m_pendingFrame->frame.reset();
+            }
+            // Capturing is owned by the GUI thread
+            QMetaObject::invokeMethod(this, "stopCapturing", Qt::QueuedConnection);
+            break;
+        }
+    }
+
+    m_output->close();
+}
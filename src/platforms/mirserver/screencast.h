@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENCAST_H
+#define SCREENCAST_H
+
+#include "framecaptureinterface.h"
+#include "screencastencoder.h"
+
+// Qt
+#include <QMutex>
+#include <QScopedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <memory>
+
+class QIODevice;
+
+/*
+ * Screencast records what a Screen shows, as encoded by ScreencastEncoder, into a file or a Unix
+ * socket.
+ *
+ * Frames are captured at most maxFramesPerSecond times a second and encoded in a thread of their
+ * own. Should encoding or writing fall behind, the frame waiting for it gets replaced by the newer
+ * one rather than queued up, so a slow disk costs frames instead of memory and render time.
+ *
+ * Enabled by setting QTMIR_SCREENCAST to the file to record to, or to "unix:<path>" for a socket
+ * to connect to. A "%1" in it is replaced by the output id, for recording several screens.
+ * QTMIR_SCREENCAST_FPS overrides the default cap of 10 frames per second.
+ *
+ * Recording stops for good once writing fails, e.g. when the other end of the socket went away.
+ *
+ * Threading Note:
+ * To be created and destroyed in the GUI thread.
+ */
+class Screencast : public QThread
+{
+    Q_OBJECT
+public:
+    static const int defaultMaxFramesPerSecond = 10;
+
+    // Takes ownership of the output, which must be open for writing
+    Screencast(qtmir::FrameCaptureInterface *frameCapture, QIODevice *output,
+               int maxFramesPerSecond = defaultMaxFramesPerSecond);
+    ~Screencast();
+
+    // Opens the file or socket described the QTMIR_SCREENCAST way. Returns nullptr on failure.
+    static QIODevice *openOutput(const QString &destination);
+
+    // Frames captured which got replaced by newer ones before being encoded
+    quint64 droppedFrameCount() const;
+
+protected:
+    void run() override;
+
+private Q_SLOTS:
+    void stopCapturing();
+
+private:
+    // Shared with the capture handler, which may still get called once stopCapturing() returned
+    struct PendingFrame {
+        QMutex mutex;
+        QWaitCondition available;
+        std::shared_ptr<const qtmir::CapturedFrame> frame;
+        bool stopping{false};
+        quint64 droppedCount{0};
+    };
+
+    qtmir::FrameCaptureInterface *const m_frameCapture;
+    const std::shared_ptr<PendingFrame> m_pendingFrame;
+    QScopedPointer<QIODevice> m_output;
+    ScreencastEncoder m_encoder; // only used by the encoding thread
+    int m_captureId;
+    bool m_capturing;
+};
+
+#endif // SCREENCAST_H
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screencastencoder.h"
+
+// Qt
+#include <QDataStream>
+#include <QVector>
+
+// std
+#include <cstring>
+
+using namespace qtmir;
+
+namespace {
+
+struct Tile {
+    quint16 column;
+    quint16 row;
+    QByteArray data;
+};
+
+// Pixels are 32 bit, so rows of tiles come in whole words
+void xorRow(quint32 *destination, const quint32 *a, const quint32 *b, int pixelCount)
+{
+    for (int i = 0; i < pixelCount; ++i) {
+        destination[i] = a[i] ^ b[i];
+    }
+}
+
+} // namespace {
+
+const int ScreencastEncoder::tileSize;
+const quint32 ScreencastEncoder::magic;
+const quint32 ScreencastEncoder::version;
+
+ScreencastEncoder::ScreencastEncoder(qint64 keyFrameInterval)
+    : m_keyFrameInterval(keyFrameInterval)
+{
+}
+
+void ScreencastEncoder::writeHeader(QDataStream &out)
+{
+    out.setVersion(QDataStream::Qt_5_4);
+    out << magic << version;
+}
+
+bool ScreencastEncoder::encode(const CapturedFrame &frame, QDataStream &out)
+{
+    const QSize size = frame.size;
+    const int bytesPerLine = size.width() * 4;
+
+    const bool keyFrame = size != m_previousSize
+        || frame.timestamp - m_lastKeyFrameTimestamp >= m_keyFrameInterval;
+    if (keyFrame) {
+        // Against zeroes, differences are the pixels themselves
+        m_previousPixels.fill(0, bytesPerLine * size.height());
+        m_previousSize = size;
+        m_lastKeyFrameTimestamp = frame.timestamp;
+    }
+
+    uchar *previousPixels = reinterpret_cast<uchar*>(m_previousPixels.data());
+    const int columns = (size.width() + tileSize - 1) / tileSize;
+    const int rows = (size.height() + tileSize - 1) / tileSize;
+
+    QVector<Tile> tiles;
+    QByteArray difference;
+
+    for (int row = 0; row < rows; ++row) {
+        const int y = row * tileSize;
+        const int tileHeight = qMin(tileSize, size.height() - y);
+
+        for (int column = 0; column < columns; ++column) {
+            const int x = column * tileSize;
+            const int tileWidth = qMin(tileSize, size.width() - x);
+            const int tileBytesPerLine = tileWidth * 4;
+
+            auto current = [&](int line) { return frame.pixels + (y + line) * frame.bytesPerLine + x * 4; };
+            auto previous = [&](int line) { return previousPixels + (y + line) * bytesPerLine + x * 4; };
+
+            bool changed = keyFrame;
+            for (int line = 0; line < tileHeight && !changed; ++line) {
+                changed = memcmp(current(line), previous(line), tileBytesPerLine) != 0;
+            }
+            if (!changed) {
+                continue;
+            }
+
+            difference.resize(tileBytesPerLine * tileHeight);
+            for (int line = 0; line < tileHeight; ++line) {
+                xorRow(reinterpret_cast<quint32*>(difference.data() + line * tileBytesPerLine),
+                       reinterpret_cast<const quint32*>(current(line)),
+                       reinterpret_cast<const quint32*>(previous(line)), tileWidth);
+                memcpy(previous(line), current(line), tileBytesPerLine);
+            }
+
+            tiles.append(Tile{quint16(column), quint16(row), qCompress(difference, 1)});
+        }
+    }
+
+    if (tiles.isEmpty()) {
+        return false;
+    }
+
+    out << frame.timestamp << quint32(size.width()) << quint32(size.height()) << quint8(keyFrame ? 1 : 0)
+        << quint32(tiles.count());
+    Q_FOREACH (const Tile &tile, tiles) {
+        out << tile.column << tile.row << tile.data;
+    }
+
+    ++m_encodedFrameCount;
+    m_encodedTileCount += tiles.count();
+    return true;
+}
+
+bool ScreencastDecoder::readHeader(QDataStream &in)
+{
+    in.setVersion(QDataStream::Qt_5_4);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    return in.status() == QDataStream::Ok
+        && magic == ScreencastEncoder::magic && version == ScreencastEncoder::version;
+}
+
+bool ScreencastDecoder::decodeFrame(QDataStream &in)
+{
+    qint64 timestamp;
+    quint32 width, height, tileCount;
+    quint8 flags;
+    in >> timestamp >> width >> height >> flags >> tileCount;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    const QSize size(width, height);
+    if (flags & 1) {
+        m_image = QImage(size, QImage::Format_RGBX8888);
+        m_image.fill(0);
+    } else if (m_image.size() != size) {
+        return false; // joined the stream after its last key frame
+    }
+
+    const int tileSize = ScreencastEncoder::tileSize;
+    for (quint32 i = 0; i < tileCount; ++i) {
+        quint16 column, row;
+        QByteArray data;
+        in >> column >> row >> data;
+
+        const int x = column * tileSize;
+        const int y = row * tileSize;
+        const int tileWidth = qMin(tileSize, size.width() - x);
+        const int tileHeight = qMin(tileSize, size.height() - y);
+        const QByteArray difference = qUncompress(data);
+        if (in.status() != QDataStream::Ok || tileWidth <= 0 || tileHeight <= 0
+                || difference.size() != tileWidth * 4 * tileHeight) {
+            return false;
+        }
+
+        for (int line = 0; line < tileHeight; ++line) {
+            auto pixels = reinterpret_cast<quint32*>(m_image.scanLine(y + line) + x * 4);
+            xorRow(pixels, pixels, reinterpret_cast<const quint32*>(difference.constData() + line * tileWidth * 4),
+                   tileWidth);
+        }
+    }
+
+    m_timestamp = timestamp;
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENCASTENCODER_H
+#define SCREENCASTENCODER_H
+
+#include "framecaptureinterface.h"
+
+// Qt
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+
+class QDataStream;
+
+/*
+ * ScreencastEncoder turns captured frames into a stream holding only what changed between them.
+ *
+ * Frames are cut into square tiles. Tiles identical to the previous frame are left out, the others
+ * are XORed with it, which leaves mostly zeroes for small changes, and compressed with zlib at its
+ * fastest level. Every keyFrameInterval, and whenever the size changes, a key frame holds all its
+ * tiles as they are, so the stream can be joined or cut from there. Frames where nothing changed
+ * aren't written at all.
+ *
+ * Stream layout, through QDataStream (Qt 5.4 format, big endian):
+ *   header:  quint32 magic 'QMSC', quint32 version
+ *   frame:   qint64 timestamp (ns), quint32 width, quint32 height, quint8 flags (1: key frame),
+ *            quint32 tile count, then per tile: quint16 column, quint16 row, QByteArray data
+ * Tile data is qCompress()ed 32 bit pixels, row after row, of tileSize or less at the edges.
+ */
+class ScreencastEncoder
+{
+public:
+    static const int tileSize = 64;
+    static const quint32 magic = 0x514d5343; // "QMSC"
+    static const quint32 version = 1;
+
+    explicit ScreencastEncoder(qint64 keyFrameInterval = 10000000000); // 10 s
+
+    void writeHeader(QDataStream &out);
+
+    // Writes what changed since the previous frame. Returns false if nothing did.
+    bool encode(const qtmir::CapturedFrame &frame, QDataStream &out);
+
+    quint64 encodedFrameCount() const { return m_encodedFrameCount; }
+    quint64 encodedTileCount() const { return m_encodedTileCount; }
+
+private:
+    const qint64 m_keyFrameInterval;
+    QByteArray m_previousPixels; // tightly packed
+    QSize m_previousSize;
+    qint64 m_lastKeyFrameTimestamp{0};
+    quint64 m_encodedFrameCount{0};
+    quint64 m_encodedTileCount{0};
+};
+
+/*
+ * ScreencastDecoder plays back what ScreencastEncoder wrote, frame after frame.
+ */
+class ScreencastDecoder
+{
+public:
+    bool readHeader(QDataStream &in);
+
+    // Applies the next frame of the stream. Returns false at the end of the stream, or on errors.
+    bool decodeFrame(QDataStream &in);
+
+    // The last frame decoded
+    const QImage &image() const { return m_image; }
+    qint64 timestamp() const { return m_timestamp; }
+
+private:
+    QImage m_image;
+    qint64 m_timestamp{0};
+};
+
+#endif // SCREENCASTENCODER_H
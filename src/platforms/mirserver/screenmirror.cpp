@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screenmirror.h"
+#include "screen.h"
+
+// Qt
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+namespace {
+
+const char *vertexShader =
+    "attribute highp vec2 position;\n"
+    "attribute highp vec2 texCoord;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    v_texCoord = texCoord;\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+const char *fragmentShader =
+    "uniform sampler2D source;\n"
+    "varying highp vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(source, v_texCoord);\n"
+    "}\n";
+
+// Both the copied frame and the framebuffer drawn into have their rows from bottom to top
+const GLfloat quad[] = {
+    // position   texCoord
+    -1.0f, -1.0f,  0.0f, 0.0f,
+     1.0f, -1.0f,  1.0f, 0.0f,
+    -1.0f,  1.0f,  0.0f, 1.0f,
+     1.0f,  1.0f,  1.0f, 1.0f,
+};
+
+} // namespace {
+
+ScreenMirror::ScreenMirror()
+    : m_texture(0)
+{
+}
+
+ScreenMirror::~ScreenMirror()
+{
+    // Without a current context the texture is gone already, along with the context it was in
+    if (m_texture && QOpenGLContext::currentContext()) {
+        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_texture);
+    }
+}
+
+void ScreenMirror::copyFrame(const QSize &size)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    // We're in the middle of the scene graph's frame, leave the texture binding as we found it
+    GLint previousTexture = 0;
+    gl->glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+    if (!m_texture) {
+        gl->glGenTextures(1, &m_texture);
+        gl->glBindTexture(GL_TEXTURE_2D, m_texture);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        gl->glBindTexture(GL_TEXTURE_2D, m_texture);
+    }
+
+    // Screen framebuffers may well have no alpha channel, and OpenGL ES refuses to copy those into
+    // a texture having one
+    if (m_textureSize != size) {
+        gl->glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 0, 0, size.width(), size.height(), 0);
+        m_textureSize = size;
+    } else {
+        gl->glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, size.width(), size.height());
+    }
+
+    gl->glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+    // The contexts of the mirrors draw from the texture, once the copy is done
+    m_frameCopied.insert();
+}
+
+void ScreenMirror::drawFrame(const QSize &size)
+{
+    // The context current is the mirror's, whose GL state nothing else touches. Qt's context only
+    // lends its functions, which are the same for all contexts of the display.
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+
+    if (!m_program) {
+        m_program.reset(new QOpenGLShaderProgram);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+        m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+        m_program->bindAttributeLocation("position", 0);
+        m_program->bindAttributeLocation("texCoord", 1);
+        m_program->link();
+    }
+
+    m_frameCopied.waitOnGpu();
+
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl->glDisable(GL_BLEND);
+    gl->glDisable(GL_DEPTH_TEST);
+    gl->glDisable(GL_SCISSOR_TEST);
+    gl->glDisable(GL_STENCIL_TEST);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gl->glViewport(0, 0, size.width(), size.height());
+    gl->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+
+    const QRect viewport = fitRect(m_textureSize, size);
+    gl->glViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+
+    m_program->bind();
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, m_texture);
+    m_program->setUniformValue("source", 0);
+
+    m_program->enableAttributeArray(0);
+    m_program->enableAttributeArray(1);
+    m_program->setAttributeArray(0, GL_FLOAT, quad, 2, 4 * sizeof(GLfloat));
+    m_program->setAttributeArray(1, GL_FLOAT, quad + 2, 2, 4 * sizeof(GLfloat));
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_program->disableAttributeArray(0);
+    m_program->disableAttributeArray(1);
+}
+
+QRect ScreenMirror::fitRect(const QSize &frame, const QSize &target)
+{
+    if (frame.isEmpty() || target.isEmpty()) {
+        return QRect(QPoint(0, 0), target);
+    }
+
+    const QSize size = frame.scaled(target, Qt::KeepAspectRatio);
+    return QRect(QPoint((target.width() - size.width()) / 2, (target.height() - size.height()) / 2), size);
+}
+
+MirrorFramePoster::MirrorFramePoster(Screen *screen)
+    : m_screen(screen)
+    , m_pending(false)
+    , m_posting(false)
+    , m_stopping(false)
+{
+    start();
+}
+
+MirrorFramePoster::~MirrorFramePoster()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeUp.wakeAll();
+    }
+    wait();
+}
+
+bool MirrorFramePoster::isIdle() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_pending && !m_posting;
+}
+
+void MirrorFramePoster::post()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending = true;
+    m_wakeUp.wakeAll();
+}
+
+void MirrorFramePoster::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (!m_pending && !m_stopping) {
+            m_wakeUp.wait(&m_mutex);
+        }
+
+        // A frame swapped into the DisplayBuffer gets posted even when stopping, or the buffer
+        // it went into would stay locked
+        if (!m_pending) {
+            return;
+        }
+
+        m_pending = false;
+        m_posting = true;
+        locker.unlock();
+        m_screen->postFrame();
+        locker.relock();
+        m_posting = false;
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENMIRROR_H
+#define SCREENMIRROR_H
+
+// Qt
+#include <QMutex>
+#include <QRect>
+#include <QScopedPointer>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtGui/qopengl.h>
+
+// local
+#include "gpufence.h"
+
+class QOpenGLShaderProgram;
+class Screen;
+
+/*
+ * ScreenMirror shows the frame a Screen rendered on the Screens mirroring it, so that cloning an
+ * output costs a copy and a textured quad per frame rather than rendering the scene once more.
+ *
+ * Before the source Screen swaps its frame, its render thread copies the frame into a texture,
+ * then draws that texture into the DisplayBuffer of each mirror, scaled to fit and centred, with
+ * the GL context of that DisplayBuffer current. The contexts of all DisplayBuffers share objects,
+ * so the texture is seen by all of them. The GPU makes the draws wait for the copy, not the thread.
+ *
+ * Threading Note:
+ * Lives in the render thread of the source Screen, with its GL context current. Also applies to
+ * its destruction, else the GL objects are left for the context to take along when it goes.
+ */
+class ScreenMirror
+{
+public:
+    ScreenMirror();
+    ~ScreenMirror();
+
+    // Copies the bottom left area of the given size off the bound framebuffer
+    void copyFrame(const QSize &size);
+
+    // Draws the copied frame into the bound framebuffer, of the given size, with black bars
+    // around it where the aspect ratios differ
+    void drawFrame(const QSize &size);
+
+    // Largest rectangle with the aspect ratio of the frame fitting in the target, centred in it
+    static QRect fitRect(const QSize &frame, const QSize &target);
+
+private:
+    GLuint m_texture;
+    QSize m_textureSize;
+    QScopedPointer<QOpenGLShaderProgram> m_program;
+    GpuFence m_frameCopied;
+};
+
+/*
+ * MirrorFramePoster posts the frames drawn into a mirroring Screen from a thread of its own.
+ *
+ * Posting blocks until the next vsync of the mirror, which the render thread of the source Screen
+ * can't wait for without halving its own frame rate whenever the outputs aren't in sync. Instead,
+ * the source skips drawing into a mirror whose previous frame is still being posted.
+ *
+ * Threading Note:
+ * Created and destroyed in the Qt GUI thread. post() and isIdle() are called from the render
+ * thread of the source Screen.
+ */
+class MirrorFramePoster : public QThread
+{
+public:
+    explicit MirrorFramePoster(Screen *screen);
+    ~MirrorFramePoster();
+
+    // Whether the previous frame got posted already
+    bool isIdle() const;
+
+    // The frame got swapped into the DisplayBuffer of the Screen, have it posted
+    void post();
+
+protected:
+    void run() override;
+
+private:
+    Screen *const m_screen;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    bool m_pending;
+    bool m_posting;
+    bool m_stopping;
+};
+
+#endif // SCREENMIRROR_H
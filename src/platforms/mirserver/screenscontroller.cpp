@@ -47,7 +47,7 @@ CustomScreenConfigurationList ScreensController::configuration()
                         screen->geometry().topLeft(),
                         screen->currentModeIndex(),
                         screen->powerMode(),
-                        mir_orientation_normal, //screen->orientation(), disable for now
+                        screen->outputOrientation(),
                         screen->scale(),
                         screen->formFactor()
             });
@@ -69,7 +69,7 @@ bool ScreensController::setConfiguration(const CustomScreenConfigurationList &ne
                     outputConfig.current_mode_index = config.currentModeIndex;
                     outputConfig.top_left = Point{ X{config.topLeft.x()}, Y{config.topLeft.y()}};
                     outputConfig.power_mode = config.powerMode;
-//                    outputConfig.orientation = config.orientation; // disabling for now
+                    outputConfig.orientation = config.orientation;
                     outputConfig.scale = config.scale;
                     outputConfig.form_factor = config.formFactor;
                 }
@@ -83,3 +83,13 @@ bool ScreensController::setConfiguration(const CustomScreenConfigurationList &ne
     m_displayConfigurationController->set_base_configuration(std::move(displayConfiguration));
     return true;
 }
+
+bool ScreensController::setMirroring(qtmir::OutputId mirror, qtmir::OutputId source)
+{
+    return m_screensModel->setMirroring(mirror, source);
+}
+
+void ScreensController::clearMirroring(qtmir::OutputId mirror)
+{
+    m_screensModel->clearMirroring(mirror);
+}
@@ -48,6 +48,10 @@ public:
     CustomScreenConfigurationList configuration();
     bool setConfiguration(const CustomScreenConfigurationList &newConfig);
 
+    // Clone mode, rendering the scene once for both outputs. See ScreensModel::setMirroring()
+    bool setMirroring(qtmir::OutputId mirror, qtmir::OutputId source);
+    void clearMirroring(qtmir::OutputId mirror);
+
 private:
     const QSharedPointer<ScreensModel> m_screensModel;
     const std::shared_ptr<mir::graphics::Display> m_display;
@@ -16,6 +16,7 @@
 
 #include "screensmodel.h"
 
+#include "displaygroupscheduler.h"
 #include "screenwindow.h"
 #include "qtcompositor.h"
 #include "logging.h"
@@ -39,6 +40,14 @@
 
 namespace mg = mir::graphics;
 
+namespace {
+bool cloneModeEnabled()
+{
+    static const bool enabled = qgetenv("QTMIR_CLONE_MODE") == "1";
+    return enabled;
+}
+} // namespace {
+
 
 ScreensModel::ScreensModel(QObject *parent)
     : QObject(parent)
@@ -174,8 +183,10 @@ void ScreensModel::update()
         Q_EMIT screenRemoved(screen); // should delete the backing Screen
     }
 
-    // Match up the new Mir DisplayBuffers with each Screen
+    // Match up the new Mir DisplayBuffers with each Screen. Screens whose DisplayBuffers are in the same
+    // DisplaySyncGroup get posted together, so share a scheduler.
     display->for_each_display_sync_group([&](mg::DisplaySyncGroup &group) {
+        auto scheduler = QSharedPointer<DisplayGroupScheduler>::create(&group);
         group.for_each_display_buffer([&](mg::DisplayBuffer &buffer) {
             // only way to match Screen to a DisplayBuffer is by matching the geometry
             QRect dbGeom(buffer.view_area().top_left.x.as_int(),
@@ -185,7 +196,7 @@ void ScreensModel::update()
 
             Q_FOREACH (auto screen, m_screenList) {
                 if (dbGeom == screen->geometry()) {
-                    screen->setMirDisplayBuffer(&buffer, &group);
+                    screen->setMirDisplayBuffer(&buffer, scheduler);
                     break;
                 }
             }
@@ -225,6 +236,8 @@ bool ScreensModel::canUpdateExistingScreen(const Screen *screen, const mg::Displ
  */
 void ScreensModel::startRenderer()
 {
+    updateMirroring(); // before exposing windows, which mirrors keep hidden
+
     Q_FOREACH (const auto screen, m_screenList) {
         // Only set windows exposed on displays which are turned on, as the GL context Mir provided
         // is invalid in that situation
@@ -250,6 +263,76 @@ void ScreensModel::haltRenderer()
             window->setExposed(false);
         }
     }
+
+    // Mirroring resumes along with rendering, on the DisplayBuffers there will be by then
+    Q_FOREACH (const auto screen, m_screenList) {
+        screen->setMirrorSource(nullptr);
+    }
+}
+
+bool ScreensModel::setMirroring(qtmir::OutputId mirrorId, qtmir::OutputId sourceId)
+{
+    Screen *mirror = findScreenWithId(m_screenList, mirrorId);
+    Screen *source = findScreenWithId(m_screenList, sourceId);
+    if (!mirror || !source || mirror == source || mirrorSource(source)) {
+        return false;
+    }
+    Q_FOREACH (Screen *screen, m_screenList) {
+        if (screen != mirror && mirrorSource(screen) == mirror) {
+            return false;
+        }
+    }
+
+    m_mirrorSources.insert(mirrorId.as_value(), sourceId.as_value());
+    updateMirroring();
+    return true;
+}
+
+void ScreensModel::clearMirroring(qtmir::OutputId mirrorId)
+{
+    if (m_mirrorSources.remove(mirrorId.as_value()) > 0) {
+        updateMirroring();
+    }
+}
+
+Screen *ScreensModel::mirrorSource(const Screen *screen) const
+{
+    auto it = m_mirrorSources.constFind(screen->outputId().as_value());
+    if (it != m_mirrorSources.constEnd()) {
+        return findScreenWithId(m_screenList, qtmir::OutputId{it.value()});
+    }
+
+    if (cloneModeEnabled() && !m_screenList.isEmpty() && screen != m_screenList.first()) {
+        return m_screenList.first();
+    }
+    return nullptr;
+}
+
+void ScreensModel::updateMirroring()
+{
+    if (!m_compositing) { // applied once rendering starts
+        return;
+    }
+
+    Q_FOREACH (const auto screen, m_screenList) {
+        Screen *source = mirrorSource(screen);
+        if (source == screen->mirrorSource()) {
+            continue;
+        }
+
+        const auto window = static_cast<ScreenWindow *>(screen->window());
+        if (source) {
+            if (window && window->window()) {
+                window->setExposed(false);
+            }
+            screen->setMirrorSource(source);
+        } else {
+            screen->setMirrorSource(nullptr);
+            if (window && window->window() && screen->powerMode() == mir_power_mode_on) {
+                window->setExposed(true);
+            }
+        }
+    }
 }
 
 Screen* ScreensModel::createScreen(const mg::DisplayConfigurationOutput &output) const
@@ -257,7 +340,7 @@ Screen* ScreensModel::createScreen(const mg::DisplayConfigurationOutput &output)
     return new Screen(output);
 }
 
-Screen* ScreensModel::findScreenWithId(const QList<Screen *> &list, const mg::DisplayConfigurationOutputId id)
+Screen* ScreensModel::findScreenWithId(const QList<Screen *> &list, const mg::DisplayConfigurationOutputId id) const
 {
     for (Screen *screen : list) {
         if (screen->m_outputId == id) {
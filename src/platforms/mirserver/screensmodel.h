@@ -17,6 +17,7 @@
 #ifndef SCREENCONTROLLER_H
 #define SCREENCONTROLLER_H
 
+#include <QHash>
 #include <QObject>
 #include <QPoint>
 
@@ -26,6 +27,8 @@
 // std
 #include <memory>
 
+#include "screentypes.h"
+
 namespace mir {
     namespace graphics { class Display; }
     namespace compositor { class DisplayListener; }
@@ -65,6 +68,13 @@ public:
 
     QWindow* getWindowForPoint(QPoint point);
 
+    // Clone mode: the mirror output shows what the source output renders, scaled to fit, instead
+    // of a scene of its own. Refused for unknown outputs, and if it would chain mirrors.
+    // With QTMIR_CLONE_MODE=1, the outputs not configured otherwise all mirror the first one.
+    bool setMirroring(qtmir::OutputId mirror, qtmir::OutputId source);
+    void clearMirroring(qtmir::OutputId mirror);
+    Screen *mirrorSource(const Screen *screen) const;
+
 Q_SIGNALS:
     void screenAdded(Screen *screen);
     void screenRemoved(Screen *screen);
@@ -88,16 +98,18 @@ protected Q_SLOTS:
     void onCompositorStopping();
 
 private:
-    Screen* findScreenWithId(const QList<Screen*> &list, const mir::graphics::DisplayConfigurationOutputId id);
+    Screen* findScreenWithId(const QList<Screen*> &list, const mir::graphics::DisplayConfigurationOutputId id) const;
     bool canUpdateExistingScreen(const Screen *screen, const mir::graphics::DisplayConfigurationOutput &output);
     void startRenderer();
     void haltRenderer();
+    void updateMirroring();
 
     std::weak_ptr<mir::graphics::Display> m_display;
     std::shared_ptr<QtCompositor> m_compositor;
     std::shared_ptr<mir::compositor::DisplayListener> m_displayListener;
     QList<Screen*> m_screenList;
     bool m_compositing;
+    QHash<int, int> m_mirrorSources; // output ids of mirrors, to those of their sources
 };
 
 #endif // SCREENCONTROLLER_H
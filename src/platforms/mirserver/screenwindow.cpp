@@ -56,11 +56,18 @@ ScreenWindow::ScreenWindow(QWindow *window)
         window->setGeometry(screenGeometry);
     }
     window->setSurfaceType(QSurface::OpenGLSurface);
+
+    if (auto quickWindow = qobject_cast<QQuickWindow *>(window)) {
+        trackFrameTiming(quickWindow);
+    }
 }
 
 ScreenWindow::~ScreenWindow()
 {
     qCDebug(QTMIR_SCREENS) << "Destroying ScreenWindow" << this;
+    Q_FOREACH (const QMetaObject::Connection &connection, m_frameTimingConnections) {
+        QObject::disconnect(connection);
+    }
     static_cast<Screen *>(screen())->setWindow(nullptr);
 }
 
@@ -75,7 +82,17 @@ void ScreenWindow::setExposed(const bool exposed)
     if (m_exposed == exposed)
         return;
 
+    // A mirror shows what its source renders, so a window of its own stays hidden
+    if (exposed && static_cast<Screen *>(screen())->mirrorSource()) {
+        qCDebug(QTMIR_SCREENS) << "ScreenWindow::setExposed" << this << "not exposed, its screen is a mirror";
+        return;
+    }
+
     m_exposed = exposed;
+
+    // Render threads of other Screens posted together with ours should not wait for this one anymore
+    static_cast<Screen *>(screen())->setRendering(exposed);
+
     if (!window())
         return;
 
@@ -85,21 +102,42 @@ void ScreenWindow::setExposed(const bool exposed)
         return;
 
     auto renderer = QSGRenderLoop::instance();
+    auto myScreen = static_cast<Screen *>(screen());
     if (exposed) {
+        const bool warm = m_warmBlankGeneration && m_warmBlankGeneration == myScreen->m_displayBufferGeneration;
+        if (m_warmBlankGeneration && !warm) {
+            qCDebug(QTMIR_SCREENS) << "ScreenWindow::setExposed" << this << "display buffer replaced while blank,"
+                                   << "dropping the scene graph";
+            quickWindow->setPersistentOpenGLContext(false);
+            quickWindow->setPersistentSceneGraph(false);
+            quickWindow->releaseResources();
+        }
+        m_warmBlankGeneration = 0;
+
+        myScreen->frameTiming().exposed(FrameTiming::now(), warm);
         renderer->show(quickWindow);
         QWindowSystemInterface::handleExposeEvent(window(), geometry()); // else it won't redraw
         QWindowSystemInterface::handleWindowActivated(window(), Qt::ActiveWindowFocusReason);
     } else {
-        quickWindow->setPersistentOpenGLContext(false);
-        quickWindow->setPersistentSceneGraph(false);
+        const bool warm = warmBlankEnabled();
+        quickWindow->setPersistentOpenGLContext(warm);
+        quickWindow->setPersistentSceneGraph(warm);
+        m_warmBlankGeneration = warm ? myScreen->m_displayBufferGeneration : 0;
         renderer->hide(quickWindow); // ExposeEvent will arrive too late, need to stop compositor immediately
     }
 }
 
+bool ScreenWindow::warmBlankEnabled()
+{
+    static const bool enabled = qgetenv("QTMIR_WARM_BLANK") == "1";
+    return enabled;
+}
+
 void ScreenWindow::setScreen(QPlatformScreen *newScreen)
 {
     // Dis-associate the old screen
     if (screen()) {
+        static_cast<Screen *>(screen())->setRendering(false);
         static_cast<Screen *>(screen())->setWindow(nullptr);
     }
 
@@ -107,12 +145,37 @@ void ScreenWindow::setScreen(QPlatformScreen *newScreen)
     auto myScreen = static_cast<Screen *>(newScreen);
     Q_ASSERT(myScreen);
     myScreen->setWindow(this);
+    myScreen->setRendering(m_exposed);
 
     QWindowSystemInterface::handleWindowScreenChanged(window(), myScreen->screen());
 
     qCDebug(QTMIR_SCREENS) << "ScreenWindow" << this << "with window ID" << uint(m_winId) << "NEWLY backed by" << myScreen;
 }
 
+void ScreenWindow::trackFrameTiming(QQuickWindow *quickWindow)
+{
+    // The scene graph phases, as seen from the render thread. Swapping is timed by Screen itself.
+    auto mark = [this](void (FrameTiming::*setMark)(qint64)) {
+        return [this, setMark]() {
+            (static_cast<Screen *>(screen())->frameTiming().*setMark)(FrameTiming::now());
+        };
+    };
+
+    m_frameTimingConnections
+        << QObject::connect(quickWindow, &QQuickWindow::beforeSynchronizing, quickWindow,
+                            mark(&FrameTiming::syncStarted), Qt::DirectConnection)
+        << QObject::connect(quickWindow, &QQuickWindow::afterSynchronizing, quickWindow,
+                            mark(&FrameTiming::syncFinished), Qt::DirectConnection)
+        << QObject::connect(quickWindow, &QQuickWindow::beforeRendering, quickWindow,
+                            mark(&FrameTiming::renderStarted), Qt::DirectConnection)
+        // Only Screens with a frame under way hold back the others posted together with them.
+        // Unlike beforeSynchronizing, beforeRendering is always followed by a swap.
+        << QObject::connect(quickWindow, &QQuickWindow::beforeRendering, quickWindow,
+                            [this]() { static_cast<Screen *>(screen())->frameStarted(); }, Qt::DirectConnection)
+        << QObject::connect(quickWindow, &QQuickWindow::afterRendering, quickWindow,
+                            mark(&FrameTiming::renderFinished), Qt::DirectConnection);
+}
+
 void ScreenWindow::swapBuffers()
 {
     static_cast<Screen *>(screen())->swapBuffers();
@@ -127,3 +190,8 @@ void ScreenWindow::doneCurrent()
 {
     static_cast<Screen *>(screen())->doneCurrent();
 }
+
+GLuint ScreenWindow::defaultFramebufferObject() const
+{
+    return static_cast<Screen *>(screen())->renderFramebuffer();
+}
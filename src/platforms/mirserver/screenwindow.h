@@ -18,10 +18,22 @@
 #define SCREENWINDOW_H
 
 #include <qpa/qplatformwindow.h>
+#include <QList>
+#include <QMetaObject>
+#include <QtGui/qopengl.h>
+
+class QQuickWindow;
 
 // ScreenWindow implements the basics of a QPlatformWindow.
 // QtMir enforces one Window per Screen, so Window and Screen are tightly coupled.
 // All Mir specifics live in the associated Screen object.
+//
+// With QTMIR_WARM_BLANK=1, a window no longer exposed keeps its GL context and scene graph, at the
+// cost of the memory they hold, so that exposing it again renders right away instead of rebuilding
+// every shader and texture. Should its Screen get a new DisplayBuffer meanwhile, the scene graph
+// is dropped on exposure, as the GL context it lived in is gone.
+//
+// A window on a Screen mirroring another one is never exposed, as the mirror shows its source's.
 
 class ScreenWindow : public QPlatformWindow
 {
@@ -39,10 +51,16 @@ public:
     void swapBuffers();
     void makeCurrent();
     void doneCurrent();
+    GLuint defaultFramebufferObject() const;
 
 private:
+    static bool warmBlankEnabled();
+    void trackFrameTiming(QQuickWindow *quickWindow);
+
     bool m_exposed;
+    quint64 m_warmBlankGeneration{0}; // of the display buffer it rendered to when hidden warm
     WId m_winId;
+    QList<QMetaObject::Connection> m_frameTimingConnections;
 };
 
 #endif // SCREENWINDOW_H
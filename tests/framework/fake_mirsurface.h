@@ -108,13 +108,21 @@ public:
     void unregisterView(qintptr viewId) override;
 
     // methods called from the rendering (scene graph) thread:
-    QSharedPointer<QSGTexture> texture() override;
-    QSGTexture *weakTexture() const override;
-    bool updateTexture() override;
-    unsigned int currentFrameNumber() const override;
-    bool numBuffersReadyForCompositor() override;
+    QSharedPointer<QSGTexture> texture(qintptr userId) override;
+    QSGTexture *weakTexture(qintptr userId) const override;
+    bool updateTexture(qintptr userId) override;
+    unsigned int currentFrameNumber(qintptr userId) const override;
+    bool numBuffersReadyForCompositor(qintptr userId) override;
+    bool wantsSnapshot() const override { return false; }
+    void setSnapshot(const QImage &) override {}
+    bool showsSnapshot() const override { return false; }
+    QImage snapshot() const override { return QImage(); }
+    QList<qtmir::FrameHandler> takeFrameCaptures() override { return QList<qtmir::FrameHandler>(); }
+    QSharedPointer<SurfaceThumbnail> thumbnail(qintptr, const QSize &, bool) override { return QSharedPointer<SurfaceThumbnail>(); }
     // end of methods called from the rendering (scene graph) thread
 
+    void captureNextFrame(const qtmir::FrameHandler &) override {}
+
     void setFocused(bool focus) override;
 
     void setViewActiveFocus(qintptr, bool) override {}
@@ -149,7 +157,7 @@ public:
 
 public Q_SLOTS:
     void requestState(Mir::State qmlState) override;
-    void onCompositorSwappedBuffers() override;
+    void onCompositorSwappedBuffers(qintptr userId) override;
 
     void setShellChrome(Mir::ShellChrome shellChrome) override;
 
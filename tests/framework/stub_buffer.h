@@ -25,14 +25,19 @@ namespace graphics {
 class StubBuffer : public Buffer
 {
 public:
-    StubBuffer() {}
+    StubBuffer() : m_size(), m_format(mir_pixel_format_invalid) {}
+    StubBuffer(geometry::Size size, MirPixelFormat format) : m_size(size), m_format(format) {}
 
     std::shared_ptr<NativeBuffer> native_buffer_handle() const override { return std::shared_ptr<NativeBuffer>(); }
     BufferID id() const override { return BufferID(); }
-    geometry::Size size() const override { return geometry::Size(); }
-    MirPixelFormat pixel_format() const override { return mir_pixel_format_invalid; }
+    geometry::Size size() const override { return m_size; }
+    MirPixelFormat pixel_format() const override { return m_format; }
 
     NativeBufferBase* native_buffer_base() override { return nullptr; }
+
+private:
+    const geometry::Size m_size;
+    const MirPixelFormat m_format;
 };
 
 } // namespace graphics
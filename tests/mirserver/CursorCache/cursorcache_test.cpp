@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cursorcache.h>
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QPixmap>
+
+using namespace qtmir;
+
+namespace {
+
+QImage cursorImage(QRgb color)
+{
+    QImage image(16, 16, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+QCursor cursorFrom(CursorCache &cache, const QImage &image, const QPoint &hotspot)
+{
+    return cache.cursor(image.constBits(), image.size(), hotspot);
+}
+
+} // namespace {
+
+class CursorCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    QGuiApplication *app;
+};
+
+void CursorCacheTest::SetUp()
+{
+    // For QPixmap
+    int argc = 0;
+    char **argv = nullptr;
+    setenv("QT_QPA_PLATFORM", "minimal", 1);
+    app = new QGuiApplication(argc, argv);
+}
+
+void CursorCacheTest::TearDown()
+{
+    delete app;
+}
+
+TEST_F(CursorCacheTest, SameImageGetsSamePixmapAndName)
+{
+    CursorCache cache;
+
+    QCursor first = cursorFrom(cache, cursorImage(qRgba(255, 0, 0, 255)), QPoint(1, 1));
+    QCursor second = cursorFrom(cache, cursorImage(qRgba(255, 0, 0, 255)), QPoint(1, 1));
+
+    EXPECT_EQ(first.pixmap().cacheKey(), second.pixmap().cacheKey());
+    EXPECT_EQ(cache.nameOf(first), cache.nameOf(second));
+    EXPECT_EQ(1, cache.count());
+    EXPECT_EQ(1u, cache.missCount());
+}
+
+TEST_F(CursorCacheTest, HotspotTellsCursorsApart)
+{
+    CursorCache cache;
+
+    QCursor first = cursorFrom(cache, cursorImage(qRgba(0, 0, 255, 255)), QPoint(0, 0));
+    QCursor second = cursorFrom(cache, cursorImage(qRgba(0, 0, 255, 255)), QPoint(8, 8));
+
+    EXPECT_NE(cache.nameOf(first), cache.nameOf(second));
+    EXPECT_EQ(2, cache.count());
+}
+
+TEST_F(CursorCacheTest, EvictsLeastRecentlyUsed)
+{
+    CursorCache cache(2);
+
+    QCursor red = cursorFrom(cache, cursorImage(qRgba(255, 0, 0, 255)), QPoint());
+    cursorFrom(cache, cursorImage(qRgba(0, 255, 0, 255)), QPoint());
+    const QString redName = cache.nameOf(red); // red is now the most recent
+
+    cursorFrom(cache, cursorImage(qRgba(0, 0, 255, 255)), QPoint()); // evicts green
+    EXPECT_EQ(2, cache.count());
+    EXPECT_EQ(redName, cache.nameOf(red));
+
+    const quint64 misses = cache.missCount();
+    cursorFrom(cache, cursorImage(qRgba(0, 255, 0, 255)), QPoint());
+    EXPECT_EQ(misses + 1, cache.missCount());
+}
+
+TEST_F(CursorCacheTest, NamesCursorsNotMadeByIt)
+{
+    CursorCache cache;
+
+    QCursor made(QPixmap::fromImage(cursorImage(qRgba(10, 20, 30, 255))), 2, 3);
+    QCursor lookalike(QPixmap::fromImage(cursorImage(qRgba(10, 20, 30, 255))), 2, 3);
+
+    EXPECT_EQ(cache.nameOf(made), cache.nameOf(lookalike));
+    EXPECT_EQ(1, cache.count());
+}
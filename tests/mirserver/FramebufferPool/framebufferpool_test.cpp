@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <framebufferpool.h>
+
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+
+namespace {
+
+// Hands out made up buffers, as there is no GL to create real ones with
+class TestableFramebufferPool : public FramebufferPool
+{
+public:
+    explicit TestableFramebufferPool(qint64 maxBytes = 1024 * 1024)
+        : FramebufferPool(maxBytes)
+    {}
+
+    ~TestableFramebufferPool()
+    {
+        clear();
+    }
+
+    QOpenGLContext *context{nullptr};
+    QList<QOpenGLFramebufferObject*> deletedBuffers;
+
+protected:
+    QOpenGLContext *currentContext() const override
+    {
+        return context;
+    }
+
+    QOpenGLFramebufferObject *createBuffer(const QSize &, const QOpenGLFramebufferObjectFormat &) override
+    {
+        return reinterpret_cast<QOpenGLFramebufferObject*>(++m_lastBuffer);
+    }
+
+    void deleteBuffer(QOpenGLFramebufferObject *buffer) override
+    {
+        deletedBuffers.append(buffer);
+    }
+
+private:
+    quintptr m_lastBuffer{0};
+};
+
+QOpenGLFramebufferObjectFormat depthStencilFormat()
+{
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    return format;
+}
+
+} // namespace {
+
+class FramebufferPoolTest : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    QGuiApplication *app;
+};
+
+void FramebufferPoolTest::SetUp()
+{
+    // For QOpenGLContext
+    int argc = 0;
+    char **argv = nullptr;
+    setenv("QT_QPA_PLATFORM", "minimal", 1);
+    app = new QGuiApplication(argc, argv);
+}
+
+void FramebufferPoolTest::TearDown()
+{
+    delete app;
+}
+
+TEST_F(FramebufferPoolTest, ReleasedBufferGetsReused)
+{
+    QOpenGLContext context;
+    TestableFramebufferPool pool;
+    pool.context = &context;
+
+    auto buffer = pool.acquire(QSize(4, 4));
+    pool.release(buffer);
+
+    EXPECT_EQ(buffer, pool.acquire(QSize(4, 4)));
+    EXPECT_EQ(1u, pool.hitCount());
+    EXPECT_EQ(1u, pool.missCount());
+    EXPECT_EQ(4 * 4 * 4, pool.totalBytes());
+}
+
+TEST_F(FramebufferPoolTest, BufferOfAnotherFormatDoesNotGetReused)
+{
+    QOpenGLContext context;
+    TestableFramebufferPool pool;
+    pool.context = &context;
+
+    auto buffer = pool.acquire(QSize(4, 4));
+    pool.release(buffer);
+
+    EXPECT_NE(buffer, pool.acquire(QSize(4, 4), depthStencilFormat()));
+    EXPECT_EQ(0u, pool.hitCount());
+    EXPECT_EQ(4 * 4 * 4 + 4 * 4 * 8, pool.totalBytes());
+}
+
+TEST_F(FramebufferPoolTest, BufferOfAnotherContextDoesNotGetReused)
+{
+    QOpenGLContext context;
+    QOpenGLContext otherContext;
+    TestableFramebufferPool pool;
+
+    pool.context = &context;
+    auto buffer = pool.acquire(QSize(4, 4));
+    pool.release(buffer);
+
+    pool.context = &otherContext;
+    EXPECT_NE(buffer, pool.acquire(QSize(4, 4)));
+    EXPECT_EQ(0u, pool.hitCount());
+}
+
+TEST_F(FramebufferPoolTest, BuffersGetDeletedWithTheirContext)
+{
+    QOpenGLContext context;
+    TestableFramebufferPool pool;
+    pool.context = &context;
+
+    auto idleBuffer = pool.acquire(QSize(4, 4));
+    auto bufferInUse = pool.acquire(QSize(4, 4));
+    pool.release(idleBuffer);
+
+    Q_EMIT context.aboutToBeDestroyed();
+    EXPECT_EQ(QList<QOpenGLFramebufferObject*>({idleBuffer}), pool.deletedBuffers);
+    EXPECT_EQ(4 * 4 * 4, pool.totalBytes());
+
+    // Not kept around for a context created later on, but not deleted by whichever thread released it
+    pool.release(bufferInUse);
+    EXPECT_EQ(QList<QOpenGLFramebufferObject*>({idleBuffer}), pool.deletedBuffers);
+    EXPECT_EQ(0, pool.totalBytes());
+
+    // Any context will do for deleting it
+    QOpenGLContext otherContext;
+    pool.context = &otherContext;
+    auto buffer = pool.acquire(QSize(4, 4));
+    EXPECT_EQ(QList<QOpenGLFramebufferObject*>({idleBuffer, bufferInUse}), pool.deletedBuffers);
+    EXPECT_NE(idleBuffer, buffer);
+    EXPECT_NE(bufferInUse, buffer);
+    EXPECT_EQ(0u, pool.hitCount());
+}
+
+TEST_F(FramebufferPoolTest, BufferOnlyFitsTheContextItWasAcquiredIn)
+{
+    QOpenGLContext context;
+    QOpenGLContext otherContext;
+    TestableFramebufferPool pool;
+
+    pool.context = &context;
+    auto buffer = pool.acquire(QSize(4, 4));
+    EXPECT_TRUE(pool.fitsCurrentContext(buffer));
+
+    pool.context = &otherContext;
+    EXPECT_FALSE(pool.fitsCurrentContext(buffer));
+
+    // Nor a context created at the same address once it is gone
+    pool.context = &context;
+    Q_EMIT context.aboutToBeDestroyed();
+    EXPECT_FALSE(pool.fitsCurrentContext(buffer));
+}
+
+TEST_F(FramebufferPoolTest, NoBufferWithoutCurrentContext)
+{
+    TestableFramebufferPool pool;
+
+    EXPECT_EQ(nullptr, pool.acquire(QSize(4, 4)));
+    EXPECT_EQ(0u, pool.missCount());
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <hardwarecursor.h>
+#include <namedcursor.h>
+
+#include <mir/graphics/cursor_image.h>
+
+using namespace ::testing;
+using namespace qtmir;
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace {
+
+struct MockCursor : mg::Cursor
+{
+    MOCK_METHOD0(show, void());
+    MOCK_METHOD1(show, void(mg::CursorImage const&));
+    MOCK_METHOD0(hide, void());
+    MOCK_METHOD1(move_to, void(geom::Point));
+};
+
+MATCHER_P(ImageOfSize, size, "") { return arg.size() == size; }
+
+} // namespace {
+
+TEST(HardwareCursorTest, IgnoresWhatMirAsksToShow)
+{
+    auto wrapped = std::make_shared<NiceMock<MockCursor>>();
+    HardwareCursor cursor(wrapped);
+
+    EXPECT_CALL(*wrapped, show()).Times(0);
+    EXPECT_CALL(*wrapped, show(_)).Times(0);
+    cursor.show();
+    cursor.show(NamedCursor("left_ptr"));
+
+    EXPECT_CALL(*wrapped, move_to(geom::Point{10, 20}));
+    cursor.move_to(geom::Point{10, 20});
+    EXPECT_EQ(QPoint(10, 20), cursor.position());
+}
+
+TEST(HardwareCursorTest, ShowsImagesUntilConcealed)
+{
+    auto wrapped = std::make_shared<NiceMock<MockCursor>>();
+    HardwareCursor cursor(wrapped);
+
+    QImage image(16, 8, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+
+    EXPECT_CALL(*wrapped, show(ImageOfSize(geom::Size{16, 8})));
+    cursor.showImage(image, QPoint(1, 2));
+    EXPECT_TRUE(cursor.isShown());
+
+    EXPECT_CALL(*wrapped, hide()).Times(1);
+    cursor.conceal();
+    cursor.conceal();
+    EXPECT_FALSE(cursor.isShown());
+}
+
+TEST(HardwareCursorTest, NameMissingFromThemeShowsNothing)
+{
+    auto wrapped = std::make_shared<NiceMock<MockCursor>>();
+    HardwareCursor cursor(wrapped);
+
+    EXPECT_CALL(*wrapped, show(_)).Times(0);
+    EXPECT_FALSE(cursor.showNamed("qtmir-test-no-such-cursor"));
+    EXPECT_FALSE(cursor.isShown());
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <capturering.h>
+
+#include <cstring>
+#include <sys/mman.h>
+
+using namespace qtmir;
+
+namespace {
+
+std::shared_ptr<const CapturedFrame> captureFrame(CaptureRing &ring, const QSize &size, uchar fill)
+{
+    const size_t byteCount = size.width() * size.height() * 4;
+    int slot;
+    uchar *pixels = ring.claim(byteCount, &slot);
+    if (!pixels) {
+        return nullptr;
+    }
+    memset(pixels, fill, byteCount);
+
+    CapturedFrame frame;
+    frame.size = size;
+    frame.bytesPerLine = size.width() * 4;
+    return ring.publish(slot, frame);
+}
+
+} // namespace {
+
+TEST(CaptureRingTest, FramesHoldOnToTheirSlot)
+{
+    CaptureRing ring(2);
+
+    auto first = captureFrame(ring, QSize(4, 4), 1);
+    auto second = captureFrame(ring, QSize(4, 4), 2);
+    ASSERT_TRUE(first && second);
+    EXPECT_NE(first->pixels, second->pixels);
+    EXPECT_EQ(0u, first->sequence);
+    EXPECT_EQ(1u, second->sequence);
+
+    // Every slot is held, so the frame gets skipped rather than overwriting one
+    EXPECT_EQ(nullptr, captureFrame(ring, QSize(4, 4), 3));
+    EXPECT_EQ(1u, ring.skippedCount());
+    EXPECT_EQ(1, first->pixels[0]);
+
+    const uchar *firstPixels = first->pixels;
+    first.reset();
+
+    auto third = captureFrame(ring, QSize(4, 4), 3);
+    ASSERT_TRUE(third != nullptr);
+    EXPECT_EQ(firstPixels, third->pixels);
+    EXPECT_EQ(2u, third->sequence);
+}
+
+TEST(CaptureRingTest, FrameCanBeMappedFromItsFd)
+{
+    CaptureRing ring;
+
+    auto frame = captureFrame(ring, QSize(8, 2), 0x5a);
+    ASSERT_TRUE(frame != nullptr);
+    ASSERT_GE(frame->fd, 0);
+
+    const size_t byteCount = frame->bytesPerLine * frame->size.height();
+    void *mapped = mmap(nullptr, byteCount, PROT_READ, MAP_SHARED, frame->fd, 0);
+    ASSERT_NE(MAP_FAILED, mapped);
+    EXPECT_EQ(0, memcmp(mapped, frame->pixels, byteCount));
+    EXPECT_EQ(0x5a, static_cast<uchar*>(mapped)[byteCount - 1]);
+    munmap(mapped, byteCount);
+}
+
+TEST(CaptureRingTest, FramesOutliveTheRing)
+{
+    std::shared_ptr<const CapturedFrame> frame;
+    {
+        CaptureRing ring;
+        frame = captureFrame(ring, QSize(16, 16), 7);
+    }
+
+    ASSERT_TRUE(frame != nullptr);
+    EXPECT_EQ(7, frame->pixels[16 * 16 * 4 - 1]);
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "fake_displayconfigurationoutput.h"
+
+#include <displaygroupscheduler.h>
+#include <screen.h>
+
+#include <mir/test/doubles/null_display_sync_group.h>
+
+#include <QElapsedTimer>
+#include <QSensorManager>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace ::testing;
+
+namespace {
+
+class CountingDisplaySyncGroup : public mir::test::doubles::NullDisplaySyncGroup
+{
+public:
+    void post() override { ++postCount; }
+
+    std::atomic<int> postCount{0};
+};
+
+class UnthrottledDisplaySyncGroup : public CountingDisplaySyncGroup
+{
+public:
+    std::chrono::milliseconds recommended_sleep() const override { return std::chrono::milliseconds(20); }
+};
+
+} // namespace {
+
+class DisplayGroupSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        if (!qEnvironmentVariableIsSet("QT_ACCEL_FILEPATH")) {
+            // Trick Qt >= 5.4.1 to load the generic sensors
+            qputenv("QT_ACCEL_FILEPATH", "dummy");
+        }
+        Screen::skipDBusRegistration = true;
+    }
+};
+
+TEST_F(DisplayGroupSchedulerTest, SingleScreenPostsEveryFrame)
+{
+    CountingDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen(fakeOutput1);
+
+    scheduler.addScreen(&screen, true);
+
+    scheduler.frameSwapped(&screen);
+    scheduler.frameSwapped(&screen);
+
+    EXPECT_EQ(2, group.postCount);
+    EXPECT_EQ(2u, scheduler.postCount());
+}
+
+TEST_F(DisplayGroupSchedulerTest, PostingSleepsAsLongAsThePlatformRecommends)
+{
+    UnthrottledDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen(fakeOutput1);
+
+    scheduler.addScreen(&screen, true);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    scheduler.frameSwapped(&screen);
+    EXPECT_EQ(1, group.postCount);
+    EXPECT_GE(elapsed.elapsed(), 20);
+}
+
+TEST_F(DisplayGroupSchedulerTest, ScreensOfAGroupArePostedOnce)
+{
+    CountingDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen1(fakeOutput1);
+    Screen screen2(fakeOutput2);
+
+    scheduler.addScreen(&screen1, true);
+    scheduler.addScreen(&screen2, true);
+    scheduler.frameStarted(&screen1);
+    scheduler.frameStarted(&screen2);
+
+    std::thread renderThread1([&] { scheduler.frameSwapped(&screen1); });
+    std::thread renderThread2([&] { scheduler.frameSwapped(&screen2); });
+    renderThread1.join();
+    renderThread2.join();
+
+    EXPECT_EQ(1, group.postCount);
+}
+
+TEST_F(DisplayGroupSchedulerTest, IdleScreenDoesNotBlockTheGroup)
+{
+    CountingDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen1(fakeOutput1);
+    Screen screen2(fakeOutput2);
+
+    scheduler.addScreen(&screen1, true);
+    scheduler.addScreen(&screen2, true);
+
+    // screen2 has nothing new to render, so screen1 gets posted without waiting for it
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (int i = 0; i < 10; ++i) {
+        scheduler.frameStarted(&screen1);
+        scheduler.frameSwapped(&screen1);
+    }
+    EXPECT_EQ(10, group.postCount);
+    EXPECT_LT(elapsed.elapsed(), 10 * 16); // waiting for screen2 takes a refresh interval of 17 ms
+}
+
+TEST_F(DisplayGroupSchedulerTest, ScreenLateWithItsFrameIsWaitedForOneIntervalAtMost)
+{
+    CountingDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen1(fakeOutput1);
+    Screen screen2(fakeOutput2);
+
+    scheduler.addScreen(&screen1, true);
+    scheduler.addScreen(&screen2, true);
+
+    // screen2 started a frame it never finishes, so screen1 gets posted once the frame interval elapsed
+    scheduler.frameStarted(&screen2);
+    scheduler.frameStarted(&screen1);
+    scheduler.frameSwapped(&screen1);
+    EXPECT_EQ(1, group.postCount);
+
+    // and not waited for at all once it stops rendering
+    scheduler.setScreenRendering(&screen2, false);
+    scheduler.frameStarted(&screen1);
+    scheduler.frameSwapped(&screen1);
+    EXPECT_EQ(2, group.postCount);
+}
+
+TEST_F(DisplayGroupSchedulerTest, DroppedFrameIsNotWaitedFor)
+{
+    CountingDisplaySyncGroup group;
+    DisplayGroupScheduler scheduler(&group);
+    Screen screen1(fakeOutput1);
+    Screen screen2(fakeOutput2);
+
+    scheduler.addScreen(&screen1, true);
+    scheduler.addScreen(&screen2, true);
+
+    // screen2 drops the frame it started, so screen1 gets posted without waiting for it
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (int i = 0; i < 10; ++i) {
+        scheduler.frameStarted(&screen1);
+        scheduler.frameStarted(&screen2);
+        scheduler.frameDropped(&screen2);
+        scheduler.frameSwapped(&screen1);
+    }
+    EXPECT_EQ(10, group.postCount);
+    EXPECT_LT(elapsed.elapsed(), 10 * 16); // waiting for screen2 takes a refresh interval of 17 ms
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <frameclock.h>
+
+namespace {
+const qint64 ms = 1000000; // ns
+}
+
+TEST(FrameClockTest, EarlyPostsAreNoVsyncs)
+{
+    FrameClock clock(50); // 20ms refresh period
+
+    clock.framePosted(100 * ms);
+    EXPECT_EQ(100 * ms, clock.lastVsync());
+
+    // Posting returned right away, before the screen could have refreshed
+    clock.framePosted(101 * ms);
+    EXPECT_EQ(100 * ms, clock.lastVsync());
+    EXPECT_EQ(20 * ms, clock.period());
+
+    // On time
+    clock.framePosted(120 * ms);
+    EXPECT_EQ(120 * ms, clock.lastVsync());
+}
+
+TEST(FrameClockTest, PeriodFollowsTheFramesPosted)
+{
+    FrameClock clock(50);
+
+    qint64 time = 0;
+    for (int i = 0; i < 200; ++i) {
+        time += 21 * ms;
+        clock.framePosted(time);
+    }
+    EXPECT_NEAR(21 * ms, clock.period(), ms / 10);
+}
+
+TEST(FrameClockTest, PeriodStaysCloseToTheModes)
+{
+    FrameClock clock(50);
+
+    qint64 time = 0;
+    for (int i = 0; i < 200; ++i) {
+        time += 30 * ms;
+        clock.framePosted(time);
+    }
+    EXPECT_EQ(22 * ms, clock.period());
+
+    // Missed vsyncs tell nothing about the period
+    clock.setRefreshRate(25);
+    clock.setRefreshRate(50);
+    EXPECT_EQ(20 * ms, clock.period());
+    for (int i = 0; i < 10; ++i) {
+        time += 45 * ms;
+        clock.framePosted(time);
+    }
+    EXPECT_EQ(20 * ms, clock.period());
+}
+
+TEST(FrameClockTest, NextVsync)
+{
+    FrameClock clock(50);
+    EXPECT_EQ(5 * ms, clock.nextVsync(5 * ms));
+
+    clock.framePosted(100 * ms);
+    EXPECT_EQ(120 * ms, clock.nextVsync(100 * ms));
+    EXPECT_EQ(120 * ms, clock.nextVsync(119 * ms));
+    EXPECT_EQ(160 * ms, clock.nextVsync(150 * ms));
+}
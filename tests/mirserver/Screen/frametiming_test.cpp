@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <frametiming.h>
+
+namespace {
+const qint64 ms = 1000000; // ns
+const qint64 refreshPeriod = 16 * ms;
+}
+
+TEST(FrameTimingHistogramTest, BucketsAreContiguous)
+{
+    for (int bucket = 0; bucket < FrameTimingHistogram::bucketCount; ++bucket) {
+        const qint64 lowerBound = FrameTimingHistogram::bucketLowerBound(bucket);
+        EXPECT_EQ(bucket, FrameTimingHistogram::bucketFor(lowerBound));
+        if (bucket > 0) {
+            EXPECT_EQ(bucket - 1, FrameTimingHistogram::bucketFor(lowerBound - 1));
+        }
+    }
+    EXPECT_EQ(FrameTimingHistogram::bucketCount - 1, FrameTimingHistogram::bucketFor(3600000000));
+}
+
+TEST(FrameTimingHistogramTest, Percentiles)
+{
+    FrameTimingHistogram histogram;
+    for (int i = 0; i < 99; ++i) {
+        histogram.record(1 * ms);
+    }
+    histogram.record(40 * ms);
+
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_EQ(40 * ms, histogram.maximum());
+
+    // Within a quarter of a power of two
+    EXPECT_GE(histogram.percentile(0.5), 1 * ms);
+    EXPECT_LE(histogram.percentile(0.5), 1 * ms * 5 / 4);
+    EXPECT_LE(histogram.percentile(0.99), 1 * ms * 5 / 4);
+    EXPECT_EQ(40 * ms, histogram.percentile(1.0));
+}
+
+TEST(FrameTimingTest, RecordsPhases)
+{
+    FrameTiming timing;
+
+    timing.syncStarted(100 * ms);
+    timing.syncFinished(101 * ms);
+    timing.renderStarted(101 * ms);
+    timing.renderFinished(105 * ms);
+    timing.swapStarted(105 * ms);
+    timing.swapFinished(106 * ms);
+    FrameTiming::Frame frame = timing.framePosted(116 * ms, refreshPeriod);
+
+    EXPECT_EQ(1 * ms, frame.durations[FrameTiming::Sync]);
+    EXPECT_EQ(4 * ms, frame.durations[FrameTiming::Render]);
+    EXPECT_EQ(1 * ms, frame.durations[FrameTiming::Swap]);
+    EXPECT_EQ(10 * ms, frame.durations[FrameTiming::VsyncWait]);
+    EXPECT_EQ(0, frame.missedVsyncs);
+    EXPECT_EQ(1u, timing.frameCount());
+
+    // Not a QQuickWindow
+    timing.swapStarted(120 * ms);
+    timing.swapFinished(121 * ms);
+    frame = timing.framePosted(132 * ms, refreshPeriod);
+    EXPECT_EQ(-1, frame.durations[FrameTiming::Sync]);
+    EXPECT_EQ(-1, frame.durations[FrameTiming::Render]);
+    EXPECT_EQ(1u, timing.histogram(FrameTiming::Sync).count());
+    EXPECT_EQ(2u, timing.histogram(FrameTiming::Swap).count());
+}
+
+TEST(FrameTimingTest, CountsMissedVsyncsOnlyWhenRenderingContinuously)
+{
+    FrameTiming timing;
+
+    timing.syncStarted(0);
+    timing.framePosted(16 * ms, refreshPeriod);
+
+    // Started right away but took two more refresh periods than it should
+    timing.syncStarted(17 * ms);
+    FrameTiming::Frame frame = timing.framePosted(64 * ms, refreshPeriod);
+    EXPECT_EQ(2, frame.missedVsyncs);
+
+    // Started after idling, so not late however long since the last one
+    timing.syncStarted(500 * ms);
+    frame = timing.framePosted(516 * ms, refreshPeriod);
+    EXPECT_EQ(0, frame.missedVsyncs);
+
+    EXPECT_EQ(2u, timing.missedVsyncCount());
+}
+
+TEST(FrameTimingTest, MeasuresFirstFrameAfterExposure)
+{
+    FrameTiming timing;
+    EXPECT_EQ(-1, timing.lastUnblankLatency());
+
+    timing.exposed(100 * ms, true);
+    timing.syncStarted(102 * ms);
+    FrameTiming::Frame frame = timing.framePosted(120 * ms, refreshPeriod);
+    EXPECT_EQ(20 * ms, frame.unblankLatency);
+    EXPECT_EQ(20 * ms, timing.lastUnblankLatency());
+    EXPECT_TRUE(timing.lastUnblankWarm());
+
+    // Only the first one
+    timing.syncStarted(121 * ms);
+    frame = timing.framePosted(136 * ms, refreshPeriod);
+    EXPECT_EQ(-1, frame.unblankLatency);
+    EXPECT_EQ(20 * ms, timing.lastUnblankLatency());
+}
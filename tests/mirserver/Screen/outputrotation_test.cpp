@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <outputrotation.h>
+
+TEST(OutputRotationTest, UprightOutputsShowScenesOfTheirOwnSize)
+{
+    EXPECT_EQ(QSize(1920, 1080), OutputRotation::sceneSize(mir_orientation_normal, QSize(1920, 1080)));
+    EXPECT_EQ(QSize(1920, 1080), OutputRotation::sceneSize(mir_orientation_inverted, QSize(1920, 1080)));
+}
+
+TEST(OutputRotationTest, SidewaysOutputsShowTransposedScenes)
+{
+    EXPECT_EQ(QSize(1080, 1920), OutputRotation::sceneSize(mir_orientation_left, QSize(1920, 1080)));
+    EXPECT_EQ(QSize(1080, 1920), OutputRotation::sceneSize(mir_orientation_right, QSize(1920, 1080)));
+}
@@ -95,11 +95,11 @@ TEST_F(ScreenTest, ReadDifferentConfigurationFromDisplayConfig)
 {
     Screen *screen = new Screen(fakeOutput2);
 
-    EXPECT_EQ(screen->geometry(), QRect(500, 600, 1500, 2000));
-    EXPECT_EQ(screen->availableGeometry(), QRect(500, 600, 1500, 2000));
+    EXPECT_EQ(screen->geometry(), QRect(500, 600, 2000, 1500));
+    EXPECT_EQ(screen->availableGeometry(), QRect(500, 600, 2000, 1500));
     EXPECT_EQ(screen->depth(), 32);
     EXPECT_EQ(screen->format(), QImage::Format_RGBX8888);
     EXPECT_EQ(screen->refreshRate(), 75);
-    EXPECT_EQ(screen->physicalSize(), QSize(1000, 2000));
+    EXPECT_EQ(screen->physicalSize(), QSize(2000, 1000));
     EXPECT_EQ(screen->outputType(), qtmir::OutputTypes::LVDS);
 }
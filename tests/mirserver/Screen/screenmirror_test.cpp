@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <screenmirror.h>
+
+TEST(ScreenMirrorTest, SameAspectRatioFillsTheTarget)
+{
+    EXPECT_EQ(QRect(0, 0, 1920, 1080), ScreenMirror::fitRect(QSize(1280, 720), QSize(1920, 1080)));
+    EXPECT_EQ(QRect(0, 0, 1280, 720), ScreenMirror::fitRect(QSize(1920, 1080), QSize(1280, 720)));
+}
+
+TEST(ScreenMirrorTest, OtherAspectRatiosGetCentred)
+{
+    // Pillarboxed
+    EXPECT_EQ(QRect(160, 0, 960, 720), ScreenMirror::fitRect(QSize(1024, 768), QSize(1280, 720)));
+    // Letterboxed
+    EXPECT_EQ(QRect(0, 96, 1024, 576), ScreenMirror::fitRect(QSize(1920, 1080), QSize(1024, 768)));
+}
+
+TEST(ScreenMirrorTest, EmptyFrameFillsTheTarget)
+{
+    EXPECT_EQ(QRect(0, 0, 800, 600), ScreenMirror::fitRect(QSize(), QSize(800, 600)));
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <screencastencoder.h>
+
+#include <QBuffer>
+#include <QDataStream>
+
+using namespace qtmir;
+
+namespace {
+
+CapturedFrame frameOf(const QImage &image, qint64 timestamp)
+{
+    CapturedFrame frame;
+    frame.pixels = image.constBits();
+    frame.size = image.size();
+    frame.bytesPerLine = image.bytesPerLine();
+    frame.format = image.format();
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+} // namespace {
+
+TEST(ScreencastEncoderTest, DecodesWhatWasEncoded)
+{
+    QImage image(150, 70, QImage::Format_RGBX8888); // tiles cut at both edges
+    image.fill(Qt::darkBlue);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QDataStream out(&buffer);
+
+    ScreencastEncoder encoder;
+    encoder.writeHeader(out);
+    ASSERT_TRUE(encoder.encode(frameOf(image, 1000), out));
+
+    image.setPixel(149, 69, qRgb(255, 0, 0));
+    image.setPixel(3, 5, qRgb(0, 255, 0));
+    ASSERT_TRUE(encoder.encode(frameOf(image, 2000), out));
+
+    buffer.seek(0);
+    QDataStream in(&buffer);
+    ScreencastDecoder decoder;
+    ASSERT_TRUE(decoder.readHeader(in));
+
+    ASSERT_TRUE(decoder.decodeFrame(in));
+    EXPECT_EQ(1000, decoder.timestamp());
+
+    ASSERT_TRUE(decoder.decodeFrame(in));
+    EXPECT_EQ(2000, decoder.timestamp());
+    EXPECT_EQ(image, decoder.image());
+
+    EXPECT_FALSE(decoder.decodeFrame(in));
+}
+
+TEST(ScreencastEncoderTest, WritesOnlyChangedTiles)
+{
+    QImage image(4 * ScreencastEncoder::tileSize, 2 * ScreencastEncoder::tileSize, QImage::Format_RGBX8888);
+    image.fill(Qt::white);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QDataStream out(&buffer);
+
+    ScreencastEncoder encoder;
+    ASSERT_TRUE(encoder.encode(frameOf(image, 0), out));
+    EXPECT_EQ(8u, encoder.encodedTileCount());
+
+    // Nothing changed, nothing gets written
+    const qint64 size = buffer.size();
+    EXPECT_FALSE(encoder.encode(frameOf(image, 1), out));
+    EXPECT_EQ(size, buffer.size());
+
+    image.setPixel(ScreencastEncoder::tileSize + 1, ScreencastEncoder::tileSize + 1, qRgb(0, 0, 0));
+    ASSERT_TRUE(encoder.encode(frameOf(image, 2), out));
+    EXPECT_EQ(9u, encoder.encodedTileCount());
+    EXPECT_EQ(2u, encoder.encodedFrameCount());
+}
+
+TEST(ScreencastEncoderTest, SizeChangeMakesKeyFrame)
+{
+    QImage image(32, 32, QImage::Format_RGBX8888);
+    image.fill(Qt::black);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QDataStream out(&buffer);
+
+    ScreencastEncoder encoder;
+    encoder.writeHeader(out);
+    ASSERT_TRUE(encoder.encode(frameOf(image, 0), out));
+
+    // All black as well, yet a different size so it has to be written
+    QImage resized(100, 20, QImage::Format_RGBX8888);
+    resized.fill(Qt::black);
+    ASSERT_TRUE(encoder.encode(frameOf(resized, 1), out));
+    EXPECT_EQ(3u, encoder.encodedTileCount());
+
+    buffer.seek(0);
+    QDataStream in(&buffer);
+    ScreencastDecoder decoder;
+    ASSERT_TRUE(decoder.readHeader(in));
+    ASSERT_TRUE(decoder.decodeFrame(in));
+    ASSERT_TRUE(decoder.decodeFrame(in));
+    EXPECT_EQ(resized, decoder.image());
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+// the test subject
+#include <Unity/Application/framepacer.h>
+
+#include <Unity/Application/timer.h>
+
+using namespace qtmir;
+using namespace testing;
+
+namespace {
+
+struct MockSurface : public FramePacer::Surface
+{
+    MOCK_CONST_METHOD0(isExposed, bool());
+    MOCK_METHOD0(dropPendingFrames, bool());
+};
+
+} // namespace {
+
+class FramePacerTest : public ::testing::Test
+{
+public:
+    FramePacerTest()
+        : timeSource(new FakeTimeSource)
+        , timer(new FakeTimer(timeSource))
+        , framePacer(timer, timeSource)
+    {
+        framePacer.setRefreshRate(50); // 20ms refresh period
+        framePacer.setHiddenSurfaceMinimumFps(5);
+    }
+
+    void advanceTime(qint64 msecs)
+    {
+        timeSource->m_msecsSinceReference += msecs;
+        timer->update();
+    }
+
+    QSharedPointer<FakeTimeSource> timeSource;
+    FakeTimer *timer;
+    FramePacer framePacer;
+};
+
+TEST_F(FramePacerTest, ExposedSurfacesGetFramesDroppedAfterAtLeast200ms)
+{
+    NiceMock<MockSurface> surface;
+    ON_CALL(surface, isExposed()).WillByDefault(Return(true));
+    ASSERT_EQ(200, framePacer.dropInterval(true));
+
+    framePacer.schedule(&surface);
+
+    EXPECT_CALL(surface, dropPendingFrames()).Times(0);
+    advanceTime(framePacer.dropInterval(true) - 1);
+    Mock::VerifyAndClearExpectations(&surface);
+
+    EXPECT_CALL(surface, dropPendingFrames()).WillOnce(Return(false));
+    advanceTime(1);
+    EXPECT_FALSE(framePacer.isScheduled(&surface));
+    EXPECT_FALSE(timer->isRunning());
+}
+
+TEST_F(FramePacerTest, HiddenSurfacesKeepTheirMinimumFrameRate)
+{
+    NiceMock<MockSurface> surface;
+    ON_CALL(surface, isExposed()).WillByDefault(Return(false));
+    ASSERT_EQ(200, framePacer.dropInterval(false));
+
+    framePacer.schedule(&surface);
+
+    // Frames keep piling up, so keep dropping them at the minimum frame rate
+    EXPECT_CALL(surface, dropPendingFrames()).Times(3).WillRepeatedly(Return(true));
+    for (int i = 0; i < 3; ++i) {
+        advanceTime(199);
+        advanceTime(1);
+    }
+    EXPECT_TRUE(framePacer.isScheduled(&surface));
+}
+
+TEST_F(FramePacerTest, SingleTimerServesAllSurfaces)
+{
+    framePacer.setHiddenSurfaceMinimumFps(1); // 1000ms, later than the exposed surface
+
+    NiceMock<MockSurface> exposedSurface;
+    ON_CALL(exposedSurface, isExposed()).WillByDefault(Return(true));
+    NiceMock<MockSurface> hiddenSurface;
+    ON_CALL(hiddenSurface, isExposed()).WillByDefault(Return(false));
+
+    framePacer.schedule(&hiddenSurface);
+    framePacer.schedule(&exposedSurface);
+
+    // Armed for the earliest deadline
+    EXPECT_EQ(framePacer.dropInterval(true), timer->interval());
+
+    EXPECT_CALL(exposedSurface, dropPendingFrames()).WillOnce(Return(false));
+    EXPECT_CALL(hiddenSurface, dropPendingFrames()).Times(0);
+    advanceTime(framePacer.dropInterval(true));
+    Mock::VerifyAndClearExpectations(&hiddenSurface);
+
+    EXPECT_CALL(hiddenSurface, dropPendingFrames()).WillOnce(Return(false));
+    advanceTime(framePacer.dropInterval(false) - framePacer.dropInterval(true));
+}
+
+TEST_F(FramePacerTest, ExposedSurfacesOnlyWaitLongerOnSlowScreens)
+{
+    framePacer.setRefreshRate(100); // 10ms refresh period
+    ASSERT_EQ(200, framePacer.dropInterval(true));
+
+    framePacer.setRefreshRate(10); // 100ms refresh period
+    ASSERT_EQ(400, framePacer.dropInterval(true));
+
+    NiceMock<MockSurface> surface;
+    ON_CALL(surface, isExposed()).WillByDefault(Return(true));
+
+    framePacer.schedule(&surface);
+    EXPECT_EQ(400, timer->interval());
+
+    EXPECT_CALL(surface, dropPendingFrames()).WillOnce(Return(false));
+    advanceTime(400);
+}
+
+TEST_F(FramePacerTest, UnscheduledSurfacesGetNoFramesDropped)
+{
+    NiceMock<MockSurface> surface;
+    framePacer.schedule(&surface);
+    framePacer.unschedule(&surface);
+
+    EXPECT_CALL(surface, dropPendingFrames()).Times(0);
+    advanceTime(1000);
+    EXPECT_FALSE(timer->isRunning());
+}
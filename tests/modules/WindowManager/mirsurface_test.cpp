@@ -24,6 +24,9 @@ struct MirEvent {}; // otherwise won't compile otherwise due to incomplete type
 #include <QLoggingCategory>
 #include <QTest>
 #include <QSignalSpy>
+#include <QThreadPool>
+
+#include <thread>
 
 // src/common
 #include "windowmodelnotifier.h"
@@ -38,6 +41,7 @@ struct MirEvent {}; // otherwise won't compile otherwise due to incomplete type
 #include <mir/test/doubles/stub_surface.h>
 
 // tests/framework
+#include "fake_session.h"
 #include "stub_buffer.h"
 #include "stub_windowcontroller.h"
 #include "mock_renderable.h"
@@ -103,6 +107,11 @@ TEST_F(MirSurfaceTest, UpdateTextureBeforeDraw)
         .WillRepeatedly(Return(std::make_shared<mir::graphics::StubBuffer>()));
 
     MirSurface surface(mockWindowInfo, nullptr);
+
+    // Held the way a MirSurfaceItem would
+    QSharedPointer<QSGTexture> texture = surface.texture((qintptr)1);
+    surface.updateTexture((qintptr)1);
+
     surface.surfaceObserver()->frame_posted(1, mir::geometry::Size{1,1});
 
     QSignalSpy spyFrameDropped(&surface, SIGNAL(frameDropped()));
@@ -110,6 +119,244 @@ TEST_F(MirSurfaceTest, UpdateTextureBeforeDraw)
     ASSERT_TRUE(spyFrameDropped.count() > 0);
 }
 
+/*
+ * Test that frames don't get dropped on behalf of a made up compositor when none consumes the
+ * surface yet, as Mir would then keep track of one more consumer for the life of the surface.
+ */
+TEST_F(MirSurfaceTest, NoFramesDroppedBeforeAnyCompositorConsumes)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv); // app for deleteLater event
+
+    auto mockSurface = std::make_shared<NiceMock<MockSurface>>();
+    miral::Window mockWindow(stubSession, mockSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+
+    ON_CALL(*mockSurface, buffers_ready_for_compositor(_))
+        .WillByDefault(Return(1));
+    EXPECT_CALL(*mockSurface, generate_renderables(_))
+        .Times(0);
+
+    MirSurface surface(mockWindowInfo, nullptr);
+    surface.surfaceObserver()->frame_posted(1, mir::geometry::Size{1,1});
+
+    QSignalSpy spyFrameDropped(&surface, SIGNAL(frameDropped()));
+    QTest::qWait(300);
+    EXPECT_EQ(0, spyFrameDropped.count());
+}
+
+/*
+ * Test that frames posted by the client from a Mir thread, while the GUI thread has yet to
+ * process the notification of an earlier one, don't queue further notifications.
+ */
+TEST_F(MirSurfaceTest, CoalescesFrameNotifications)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv); // app for queued signals
+
+    auto mockSurface = std::make_shared<NiceMock<MockSurface>>();
+    miral::Window mockWindow(stubSession, mockSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+
+    MirSurface surface(mockWindowInfo, nullptr);
+    QSignalSpy spyFramesPosted(&surface, SIGNAL(framesPosted()));
+
+    std::thread mirThread([&surface]() {
+        for (int i = 0; i < 10; ++i) {
+            surface.surfaceObserver()->frame_posted(1, mir::geometry::Size{1,1});
+        }
+    });
+    mirThread.join();
+
+    EXPECT_EQ(10u, surface.framesPostedCount());
+    EXPECT_EQ(9u, surface.collapsedFrameNotificationCount());
+
+    qtApp.processEvents();
+    EXPECT_EQ(1, spyFramesPosted.count());
+
+    // Once consumed, the next frame gets notified again
+    std::thread([&surface]() {
+        surface.surfaceObserver()->frame_posted(1, mir::geometry::Size{1,1});
+    }).join();
+    qtApp.processEvents();
+    EXPECT_EQ(2, spyFramesPosted.count());
+    EXPECT_EQ(9u, surface.collapsedFrameNotificationCount());
+}
+
+/*
+ * Test that once its client is suspended, a surface asks for a snapshot of its last frame and keeps
+ * showing it after resuming, until the client posts a new frame.
+ */
+TEST_F(MirSurfaceTest, SnapshotStandsInForSuspendedClientUntilNextFrame)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv); // app for queued signals
+
+    auto mockSurface = std::make_shared<NiceMock<MockSurface>>();
+    miral::Window mockWindow(stubSession, mockSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+    mockWindowInfo.userdata(std::make_shared<ExtraWindowInfo>());
+
+    FakeSession session;
+    session.setState(SessionInterface::Running);
+    MirSurface surface(mockWindowInfo, nullptr, &session);
+    QSignalSpy spySnapshotChanged(&surface, SIGNAL(snapshotChanged()));
+
+    session.setState(SessionInterface::Suspended);
+    EXPECT_TRUE(surface.wantsSnapshot());
+    EXPECT_EQ(1, spySnapshotChanged.count());
+
+    QImage lastFrame(4, 4, QImage::Format_RGBA8888);
+    lastFrame.fill(Qt::red);
+    surface.setSnapshot(lastFrame);
+    EXPECT_FALSE(surface.wantsSnapshot());
+    EXPECT_TRUE(surface.showsSnapshot());
+
+    // Once compressed, it gets decoded back in the background rather than by whoever asks for it
+    QThreadPool::globalInstance()->waitForDone();
+    EXPECT_TRUE(surface.snapshot().isNull());
+    QThreadPool::globalInstance()->waitForDone();
+    qtApp.processEvents();
+    EXPECT_EQ(3, spySnapshotChanged.count());
+    EXPECT_EQ(lastFrame, surface.snapshot());
+
+    session.setState(SessionInterface::Running);
+    EXPECT_TRUE(surface.showsSnapshot());
+
+    surface.surfaceObserver()->frame_posted(1, mir::geometry::Size{1,1});
+    qtApp.processEvents();
+    EXPECT_FALSE(surface.showsSnapshot());
+    EXPECT_TRUE(surface.snapshot().isNull());
+}
+
+/*
+ * Test that buffer queries are made on behalf of the compositor asking for them, so that
+ * each Screen consumes the client buffer queue independently.
+ */
+TEST_F(MirSurfaceTest, BufferQueriesUseCompositorId)
+{
+    auto mockSurface = std::make_shared<NiceMock<MockSurface>>();
+    miral::Window mockWindow(stubSession, mockSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+
+    const qintptr firstCompositor = 1;
+    const qintptr secondCompositor = 2;
+
+    EXPECT_CALL(*mockSurface.get(),buffers_ready_for_compositor((void*)firstCompositor))
+        .WillRepeatedly(Return(1));
+    EXPECT_CALL(*mockSurface.get(),buffers_ready_for_compositor((void*)secondCompositor))
+        .WillRepeatedly(Return(0));
+
+    MirSurface surface(mockWindowInfo, nullptr);
+
+    EXPECT_TRUE(surface.numBuffersReadyForCompositor(firstCompositor));
+    EXPECT_FALSE(surface.numBuffersReadyForCompositor(secondCompositor));
+
+    // no texture was ever requested by those compositors
+    EXPECT_FALSE(surface.updateTexture(firstCompositor));
+    EXPECT_EQ(0u, surface.currentFrameNumber(firstCompositor));
+    EXPECT_EQ(nullptr, surface.weakTexture(secondCompositor));
+}
+
+/*
+ * Test that a surface gives its buffers back only once it has gone without views for a while,
+ * and that a view coming back in the meantime keeps them.
+ */
+TEST_F(MirSurfaceTest, ReleasesBuffersOnlyAfterGoingUnviewed)
+{
+    miral::Window mockWindow(stubSession, stubSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+
+    MirSurface surface(mockWindowInfo, nullptr);
+
+    QSharedPointer<FakeTimeSource> fakeTimeSource(new FakeTimeSource);
+    QPointer<FakeTimer> fakeTimer(new FakeTimer(fakeTimeSource));
+    surface.setBufferReleaseTimer(fakeTimer.data()); // surface takes ownership of the timer
+
+    qintptr view = (qintptr)1;
+    surface.registerView(view);
+    EXPECT_FALSE(fakeTimer->isRunning());
+
+    surface.unregisterView(view);
+    EXPECT_TRUE(fakeTimer->isRunning());
+
+    surface.registerView(view);
+    EXPECT_FALSE(fakeTimer->isRunning());
+
+    surface.unregisterView(view);
+    ASSERT_TRUE(fakeTimer->isRunning());
+    fakeTimeSource->m_msecsSinceReference = fakeTimer->nextTimeoutTime() + 1;
+    fakeTimer->update();
+
+    // no compositor ever took a buffer from it
+    EXPECT_FALSE(fakeTimer->isRunning());
+    EXPECT_EQ(0u, surface.reclaimedBufferBytes());
+    EXPECT_EQ(nullptr, surface.weakTexture((qintptr)1));
+
+    surface.setLive(false);
+}
+
+/*
+ * Test that the client buffer a compositor still holds through the texture of a surface gone
+ * without views gets given back, even though the texture itself lives on.
+ */
+TEST_F(MirSurfaceTest, ReleasesBufferHeldByCompositorAfterGoingUnviewed)
+{
+    auto mockSurface = std::make_shared<NiceMock<MockSurface>>();
+    miral::Window mockWindow(stubSession, mockSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo mockWindowInfo(mockWindow, spec);
+    auto mockRenderable = std::make_shared<NiceMock<mir::graphics::MockRenderable>>();
+
+    auto buffer = std::make_shared<mir::graphics::StubBuffer>(mir::geometry::Size{10, 20}, mir_pixel_format_abgr_8888);
+    std::weak_ptr<mir::graphics::Buffer> weakBuffer = buffer;
+
+    ON_CALL(*mockSurface, buffers_ready_for_compositor(_))
+        .WillByDefault(Return(1));
+    ON_CALL(*mockSurface, generate_renderables(_))
+        .WillByDefault(Return(mir::graphics::RenderableList{mockRenderable}));
+    EXPECT_CALL(*mockRenderable, buffer())
+        .WillOnce(Return(buffer));
+
+    MirSurface surface(mockWindowInfo, nullptr);
+
+    QSharedPointer<FakeTimeSource> fakeTimeSource(new FakeTimeSource);
+    QPointer<FakeTimer> fakeTimer(new FakeTimer(fakeTimeSource));
+    surface.setBufferReleaseTimer(fakeTimer.data()); // surface takes ownership of the timer
+
+    // Releasing takes no GL, so no compositor window or GL context is needed
+    const qintptr compositor = (qintptr)1;
+    qintptr view = (qintptr)2;
+    surface.registerView(view);
+
+    // Held the way a MirSurfaceItem would
+    QSharedPointer<QSGTexture> texture = surface.texture(compositor);
+    ASSERT_TRUE(surface.updateTexture(compositor));
+    Mock::VerifyAndClearExpectations(mockRenderable.get());
+    buffer.reset();
+    ASSERT_FALSE(weakBuffer.expired());
+
+    surface.unregisterView(view);
+    ASSERT_TRUE(fakeTimer->isRunning());
+    fakeTimeSource->m_msecsSinceReference = fakeTimer->nextTimeoutTime() + 1;
+    fakeTimer->update();
+
+    EXPECT_TRUE(weakBuffer.expired());
+    EXPECT_FALSE(static_cast<MirBufferSGTexture*>(texture.data())->hasBuffer());
+    EXPECT_EQ(10u * 20u * 4u, surface.reclaimedBufferBytes());
+    EXPECT_EQ(nullptr, surface.weakTexture(compositor));
+
+    surface.setLive(false);
+}
+
 /*
  * Test that MirSurface.visible is recalculated after the client swaps the first frame.
  * A surface is not considered visible unless it has a non-hidden & non-minimized state, and
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_INCLUDE_DEPRECATED_EVENT_HEADER
+
+struct MirEvent {}; // otherwise won't compile otherwise due to incomplete type
+
+#include <gtest/gtest.h>
+
+#include <QGuiApplication>
+#include <QLoggingCategory>
+#include <QQuickWindow>
+#include <private/qquickitem_p.h>
+
+// the test subject
+#include <Unity/Application/mirsurfaceitem.h>
+
+// tests/framework
+#include <fake_mirsurface.h>
+
+using namespace qtmir;
+
+/*
+  Tests that a MirSurfaceItem only repaints its window for the surface frames that would
+  change something in it, and that it catches up on the others once they would.
+ */
+class MirSurfaceItemFramesTest : public ::testing::Test
+{
+public:
+    MirSurfaceItemFramesTest()
+    {
+        setenv("QT_QPA_PLATFORM", "minimal", 1);
+        int argc = 0;
+        char **argv = nullptr;
+        m_app = new QGuiApplication(argc, argv);
+
+        // We don't want the logging spam cluttering the test results
+        QLoggingCategory::setFilterRules(QStringLiteral("qtmir.surfaces=false"));
+
+        m_fakeSurface = new FakeMirSurface;
+
+        m_window = new QQuickWindow;
+        m_window->resize(100, 100);
+
+        m_surfaceItem = new MirSurfaceItem(m_window->contentItem());
+        m_surfaceItem->setSize(QSizeF(50, 50));
+        m_surfaceItem->setSurface(m_fakeSurface);
+        takeRepaintRequest();
+    }
+    virtual ~MirSurfaceItemFramesTest()
+    {
+        delete m_window;
+        delete m_fakeSurface;
+        delete m_app;
+    }
+
+    // Whether the item asked for a repaint since the last call
+    bool takeRepaintRequest()
+    {
+        QQuickItemPrivate *itemPrivate = QQuickItemPrivate::get(m_surfaceItem);
+        const bool requested = itemPrivate->dirtyAttributes & QQuickItemPrivate::Content;
+        itemPrivate->dirtyAttributes &= ~QQuickItemPrivate::Content;
+        return requested;
+    }
+
+    QGuiApplication *m_app;
+    QQuickWindow *m_window;
+    FakeMirSurface *m_fakeSurface;
+    MirSurfaceItem *m_surfaceItem;
+};
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfShownItemRepaintWindow)
+{
+    Q_EMIT m_fakeSurface->framesPosted();
+
+    EXPECT_TRUE(takeRepaintRequest());
+}
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfItemWithoutWindowDontRepaint)
+{
+    m_surfaceItem->setParentItem(nullptr);
+    takeRepaintRequest();
+
+    Q_EMIT m_fakeSurface->framesPosted();
+
+    EXPECT_FALSE(takeRepaintRequest());
+
+    m_surfaceItem->setParentItem(m_window->contentItem());
+}
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfHiddenItemRepaintOnceShown)
+{
+    m_surfaceItem->setVisible(false);
+    takeRepaintRequest();
+
+    Q_EMIT m_fakeSurface->framesPosted();
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_FALSE(takeRepaintRequest());
+
+    m_surfaceItem->setVisible(true);
+    takeRepaintRequest();
+
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_TRUE(takeRepaintRequest());
+
+    // Caught up already
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_FALSE(takeRepaintRequest());
+}
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfItemInTransparentParentDontRepaint)
+{
+    QQuickItem parent(m_window->contentItem());
+    m_surfaceItem->setParentItem(&parent);
+    parent.setOpacity(0);
+    takeRepaintRequest();
+
+    Q_EMIT m_fakeSurface->framesPosted();
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_FALSE(takeRepaintRequest());
+
+    parent.setOpacity(0.5);
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_TRUE(takeRepaintRequest());
+
+    m_surfaceItem->setParentItem(m_window->contentItem());
+}
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfItemOutsideWindowDontRepaint)
+{
+    m_surfaceItem->setPosition(QPointF(150, 0));
+    takeRepaintRequest();
+
+    Q_EMIT m_fakeSurface->framesPosted();
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_FALSE(takeRepaintRequest());
+
+    // Partially inside
+    m_surfaceItem->setPosition(QPointF(75, 75));
+    Q_EMIT m_window->afterAnimating();
+    EXPECT_TRUE(takeRepaintRequest());
+}
+
+TEST_F(MirSurfaceItemFramesTest, FramesOfItemUsedByEffectRepaint)
+{
+    // Say a ShaderEffectSource shows the item somewhere else, while the item itself is off-window
+    QQuickItemPrivate *itemPrivate = QQuickItemPrivate::get(m_surfaceItem);
+    m_surfaceItem->setPosition(QPointF(150, 0));
+    m_surfaceItem->setOpacity(0);
+    itemPrivate->refFromEffectItem(false);
+    takeRepaintRequest();
+
+    Q_EMIT m_fakeSurface->framesPosted();
+    EXPECT_TRUE(takeRepaintRequest());
+
+    itemPrivate->derefFromEffectItem(false);
+
+    Q_EMIT m_fakeSurface->framesPosted();
+    EXPECT_FALSE(takeRepaintRequest());
+}
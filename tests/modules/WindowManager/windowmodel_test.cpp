@@ -704,6 +704,116 @@ TEST_F(WindowModelTest, WindowReadyCausesMirSurfaceToEmitReadySignal)
 }
 
 
+struct PlacedStubSurface : public mir::test::doubles::StubSurface
+{
+    PlacedStubSurface(QRect geometry, MirPixelFormat format)
+        : m_geometry(geometry), m_format(format) {}
+
+    mir::geometry::Point top_left() const override { return toMirPoint(m_geometry.topLeft()); }
+    mir::geometry::Size size() const override { return toMirSize(m_geometry.size()); }
+    bool visible() const override { return true; }
+    float alpha() const override { return 1.0f; }
+    MirPixelFormat pixel_format() const override { return m_format; }
+
+private:
+    QRect m_geometry;
+    MirPixelFormat m_format;
+};
+
+class WindowModelOcclusionTest : public WindowModelTest
+{
+public:
+    // Adds the window at the top of the stack
+    NewWindow addWindow(WindowModelNotifier &notifier, QRect geometry, MirPixelFormat format = mir_pixel_format_xrgb_8888)
+    {
+        const miral::Application app{stubSession};
+        const miral::Window window{app, std::make_shared<PlacedStubSurface>(geometry, format)};
+
+        ms::SurfaceCreationParameters windowSpec;
+        miral::WindowInfo windowInfo{window, windowSpec};
+        NewWindow newWindow{windowInfo};
+        notifier.windowAdded(newWindow);
+        flushEvents();
+        return newWindow;
+    }
+};
+
+/*
+ * Test: that a window fully covered by an opaque window stacked on top of it is marked as occluded
+ */
+TEST_F(WindowModelOcclusionTest, WindowCoveredByOpaqueWindowIsOccluded)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+    model.setOcclusionCulling(true);
+
+    addWindow(notifier, QRect(100, 100, 200, 200));
+    addWindow(notifier, QRect(50, 50, 400, 400));
+
+    EXPECT_TRUE(getMirSurfaceFromModel(model, 0)->isOccluded());
+    EXPECT_FALSE(getMirSurfaceFromModel(model, 1)->isOccluded());
+}
+
+/*
+ * Test: that windows are not told they're occluded unless the shell enables occlusion culling,
+ * as it may show them elsewhere than where Mir has them
+ */
+TEST_F(WindowModelOcclusionTest, OcclusionCullingIsOptIn)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+    ASSERT_FALSE(model.occlusionCulling());
+
+    addWindow(notifier, QRect(100, 100, 200, 200));
+    addWindow(notifier, QRect(50, 50, 400, 400));
+    EXPECT_FALSE(getMirSurfaceFromModel(model, 0)->isOccluded());
+
+    model.setOcclusionCulling(true);
+    EXPECT_TRUE(getMirSurfaceFromModel(model, 0)->isOccluded());
+
+    model.setOcclusionCulling(false);
+    EXPECT_FALSE(getMirSurfaceFromModel(model, 0)->isOccluded());
+}
+
+/*
+ * Test: that a window is occluded only if the windows on top of it cover all of it, and only
+ * if they are opaque
+ */
+TEST_F(WindowModelOcclusionTest, PartiallyCoveredOrTranslucentlyCoveredWindowIsNotOccluded)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+    model.setOcclusionCulling(true);
+
+    addWindow(notifier, QRect(0, 0, 200, 200));
+    addWindow(notifier, QRect(100, 0, 200, 200));
+    addWindow(notifier, QRect(0, 0, 400, 400), mir_pixel_format_argb_8888);
+
+    EXPECT_FALSE(getMirSurfaceFromModel(model, 0)->isOccluded());
+    EXPECT_FALSE(getMirSurfaceFromModel(model, 1)->isOccluded());
+}
+
+/*
+ * Test: that raising an occluded window over the one covering it makes it no longer occluded
+ */
+TEST_F(WindowModelOcclusionTest, RaisingOccludedWindowUnoccludesIt)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+    model.setOcclusionCulling(true);
+
+    auto bottomWindow = addWindow(notifier, QRect(100, 100, 200, 200));
+    addWindow(notifier, QRect(0, 0, 400, 400));
+    auto surface = getMirSurfaceFromModel(model, 0);
+    ASSERT_TRUE(surface->isOccluded());
+
+    notifier.windowsRaised({bottomWindow.windowInfo.window()});
+    flushEvents();
+
+    EXPECT_FALSE(surface->isOccluded());
+}
+
+
 class WindowModelTestTypes : public WindowModelTest, public ::testing::WithParamInterface<Mir::State>
 {
 public: